@@ -13,16 +13,63 @@
 #include <stdbool.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
 
 #include "spi.h"
 #include "sequencer_utils.h"
 
+/*
+ * Geometry the rest of the firmware is laid out for. Any part whose probe 
+ * (mem_init) finds 256 byte pages and 4KB erases works; capacity, block 
+ * erases and addressing come from the probe (mem_geometry)
+ */
+#define MEM_PAGE_SIZE       0x100   // page program granularity (256 bytes)
+#define MEM_SECTOR_SIZE     0x1000  // smallest erase granularity (4KB)
+#define MEM_ADDR3_MAX       0x1000000UL // largest part with 3-byte addresses
+#define MEM_BLOCK32_SIZE    0x8000  // 32KB block erase (0x52)
+#define MEM_BLOCK64_SIZE    0x10000 // 64KB block erase (0xD8)
+#define MEM_TSUS_US         20      // erase suspend latency, also the minimum
+                                    // time from a resume to the next suspend
+#define MEM_TDP_US          3       // CS high after 0xB9 to power-down
+#define MEM_TRES1_US        3       // CS high after 0xAB to the next instruction
+#define MEM_CRC_INIT        0xFFFF  // CRC-16/CCITT (poly 0x1021) start value
+
+/*
+ * External flash memory map; every region starts on a sector boundary
+ * so it can be erased without disturbing its neighbours
+ */
+#define MEM_CONTEXT_ADDR    0x000000    // saveContext()/restoreContext()
+#define MEM_CAL_ADDR        0x001000    // ADC->DAC calibration table
+#define MEM_SONG_ADDR       0x002000    // song mode pattern chain
+#define MEM_CONTEXT_B_ADDR  0x003000    // second copy of the context
+#define MEM_REC_ADDR        0x200000    // full-gate recording slots, to the end
+
+typedef struct mem_geometry {
+    
+    uint8_t jedec[3];       // manufacturer, memory type, capacity (0x9F)
+    bool sfdp;              // geometry read from the SFDP basic table
+    uint32_t size;          // bytes
+    uint16_t pageSize;      // bytes
+    uint8_t erase4k;        // erase opcodes, 0 if not supported
+    uint8_t erase32k;
+    uint8_t erase64k;
+    bool fastRead;          // 0x0B with 8 dummy clocks
+    bool addr4;             // 4-byte addresses (parts over 16MB)
+    
+} mem_geometry_t;
+
 void mem_init(void);
+const mem_geometry_t *mem_geometry(void);
 void mem_writeEnable(bool);
-void mem_pageProgram(uint32_t, uint16_t);
+void mem_pageProgramWord(uint32_t, uint16_t);
+void mem_pageProgramInit(uint32_t);
+void mem_pageProgramData(uint8_t);
+void mem_pageProgramEnd(void);
 void mem_readInit(uint32_t);
+void mem_fastReadInit(uint32_t);
 uint8_t mem_readData(void);
+void mem_readEnd(void);
 void mem_display(uint32_t, uint32_t, char*);
 uint8_t mem_readSR1(void);
 uint8_t mem_readSR2(void);
@@ -30,6 +77,18 @@ uint8_t mem_readSR3(void);
 void mem_waitBusy(void);
 void mem_sectorErase(uint32_t);
 void mem_erase(void);
+bool mem_eraseStart(uint32_t, uint32_t);
+void mem_eraseService(void);
+void mem_eraseRange(uint32_t, uint32_t);
+bool mem_erasing(void);
+bool mem_writable(void);
+void mem_powerDown(void);
+void mem_wake(void);
+void mem_wakeSoon(void);
+void mem_wakeService(void);
+uint16_t mem_crc16(uint16_t, uint8_t);
+void mem_crcStart(void);
+uint16_t mem_crc(void);
 
 
 
@@ -11,6 +11,41 @@
 #define ADC_NUM_CHANNELS        0x2
 #define ADC_MAX_CHANNEL         0x8
 
+/*
+ * Oversampling of the free running CV input. Every result is the sum of
+ * 4^ADC_OVERSAMPLE_BITS 10-bit conversions accumulated in hardware
+ * (SAMPNUM), decimated by ADC_OVERSAMPLE_BITS, for ADC_RESULT_BITS of
+ * effective resolution. 0 gives plain 10-bit samples, 3 is the maximum
+ * (64 samples accumulated).
+ */
+#define ADC_OVERSAMPLE_BITS     2
+#define ADC_RESULT_BITS         (10 + ADC_OVERSAMPLE_BITS)
+
+#if ADC_OVERSAMPLE_BITS == 0
+#define ADC_SAMPNUM_OVS_gc      ADC_SAMPNUM_ACC1_gc
+#elif ADC_OVERSAMPLE_BITS == 1
+#define ADC_SAMPNUM_OVS_gc      ADC_SAMPNUM_ACC4_gc
+#elif ADC_OVERSAMPLE_BITS == 2
+#define ADC_SAMPNUM_OVS_gc      ADC_SAMPNUM_ACC16_gc
+#elif ADC_OVERSAMPLE_BITS == 3
+#define ADC_SAMPNUM_OVS_gc      ADC_SAMPNUM_ACC64_gc
+#else
+#error "ADC_OVERSAMPLE_BITS must be 0 to 3"
+#endif
+
+/*
+ * Background scan. Slots 0-7 are AIN0-7 (PD0-PD7), slot ADC_CH_CV is the
+ * CV input (AIN13, PF3).
+ * 
+ * ADC_SCAN_RATES sets how many CV results pass between two conversions of
+ * each AIN0-7 channel, 0 to leave it out. PD0-PD3 drive LEDs, PD4 is the
+ * playback button and PD6 the gate comparator input, so only AIN5 (PD5) and
+ * AIN7 (PD7) are free for pots/CV inputs on the current board.
+ */
+#define ADC_CH_CV               ADC_MAX_CHANNEL
+#define ADC_SCAN_SLOTS          (ADC_MAX_CHANNEL + 1)
+#define ADC_SCAN_RATES          {0, 0, 0, 0, 0, 8, 0, 8}
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -20,12 +55,21 @@
 
 void ADC0mux_init(void);
 void ADC0free_init(void);
+void ADC0scan_init(void);
+void ADC0_pinInit(uint8_t);
 uint8_t ADC0mux_read(void);
 uint16_t ADC0free_read(void);
 void ADC0_start(void);
 void ADC0_stop(void);
 bool ADC0_conversionDone(void);
 void ADC0_mux(uint8_t);
+void ADC0_scanNext(void);
+uint16_t ADC0_value(uint8_t);
+uint16_t ADC0_latest(void);
+void ADC0_setRate(uint8_t, uint8_t);
+void ADC0_scanPause(void);
+void ADC0_scanResume(void);
+uint16_t ADC0_next(void);
 
 #endif	/* ADC_H */
 
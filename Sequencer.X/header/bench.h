@@ -0,0 +1,37 @@
+/*
+ * File:   bench.h
+ * Author: N Mark
+ *
+ * Timestamp source for on-target measurements. TCB3 free-runs on CLK_PER,
+ * so one tick is 1/F_CPU (0.3us) and the counter wraps every ~19.6ms.
+ *
+ * @NOTE: Differences of bench_now() values are valid across a wrap as long
+ *        as the measured interval is shorter than BENCH_MAX_US
+ *
+ */
+
+#ifndef BENCH_H
+#define	BENCH_H
+
+#define BENCH_MAX_US        19660   // longest measurable interval
+#define BENCH_SPI_FRAMES    64      // DAC frames timed by bench_spi
+#define BENCH_SPI_MIX       16      // flash bytes per DAC frame, power of 2
+
+/* uncomment to print the measured throughput of each SPI0 profile on boot */
+//#define SPI_BENCHMARK
+
+/* ticks -> microseconds, rounded down */
+#define BENCH_TICKS_TO_US(t)    ((uint32_t)(t) * 1000000UL / F_CPU)
+/* microseconds -> ticks, rounded up; constant for a constant us */
+#define BENCH_US_TO_TICKS(us)   ((uint16_t)(((uint32_t)(us) * F_CPU + 999999UL) / 1000000UL))
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void bench_init(void);
+uint16_t bench_now(void);
+void bench_spi(void);
+
+#endif	/* BENCH_H */
+
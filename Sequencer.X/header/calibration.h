@@ -0,0 +1,55 @@
+/*
+ * File:   calibration.h
+ * Author: N Mark
+ *
+ * Per-unit ADC->DAC calibration. A lookup table indexed by the top
+ * CAL_TABLE_BITS of the ADC code holds the gain/offset corrected MCP4922
+ * code; the remaining low bits of an oversampled code are interpolated
+ * between neighbouring entries.
+ *
+ * @NOTE: The table is built over USART3 by cal_run() and stored at
+ *        MEM_CAL_ADDR on the external flash; cal_init() loads it on boot
+ *
+ */
+
+#ifndef CALIBRATION_H
+#define	CALIBRATION_H
+
+#define CAL_TABLE_BITS      10      // ADC resolution the table is indexed by
+#define CAL_TABLE_SIZE      (1 << CAL_TABLE_BITS)
+#define CAL_TABLE_SHIFT     (ADC_RESULT_BITS - CAL_TABLE_BITS) // interpolated bits
+#define CAL_MAGIC           0xCA1C  // marks a valid table in flash
+#define CAL_SAMPLES         64      // ADC samples averaged per input point
+
+/* reference voltages (mV) applied to the CV input during calibration */
+#define CAL_IN_LO_MV        1000
+#define CAL_IN_HI_MV        4000
+
+/* DAC codes whose output voltages are measured during calibration */
+#define CAL_DAC_LO_CODE     512
+#define CAL_DAC_HI_CODE     3584
+#define CAL_DAC_MAX_CODE    4095
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include "adc.h"
+
+#if CAL_TABLE_SHIFT < 0
+#error "ADC_RESULT_BITS must be at least CAL_TABLE_BITS"
+#endif
+
+/*
+ * ADC code >> CAL_TABLE_SHIFT -> DAC code; loaded into SRAM by cal_init().
+ * The extra entry is the upper end point for interpolating the last one
+ */
+extern uint16_t calTable[CAL_TABLE_SIZE + 1];
+
+void cal_init(void);
+void cal_run(void);
+void cal_load(void);
+void cal_store(void);
+uint16_t cal_lookup(uint16_t);
+
+#endif	/* CALIBRATION_H */
+
@@ -0,0 +1,51 @@
+/*
+ * File:   clock.h
+ * Author: N Mark
+ *
+ * Clock input conditioning and division in hardware.
+ *
+ * With CLOCK_DIVIDER the gate comparator no longer interrupts on every
+ * rising edge. Its output takes this path instead:
+ *      - AC0 OUT -> event channel 3 -> CCL LUT0 input A
+ *      - LUT0 passes it through its filter: a level has to hold for a few
+ *        CLK_PER before the output follows, so glitches are dropped
+ *      - LUT0 OUT -> event channel 4 -> TCA0, which counts the rising
+ *        edges up to PER and interrupts on the overflow
+ * TCA0.PER is the current pattern's clock division less one, so a pattern
+ * stepping on every Nth edge costs one interrupt per step, not N. The
+ * comparator's hysteresis is also raised to CLOCK_AC_HYSMODE.
+ *
+ * Each pattern has its division (1 to CLOCK_DIV_MAX); the pot on AIN7
+ * (PD7) sets it for the current pattern. It is switched on the step the
+ * edited pattern (or the next song entry) is swapped in.
+ *
+ * @NOTE: Not with MIDI_INPUT, which replaces the gate as the clock, nor
+ *        with GATE_OUTPUT, whose timebase is TCA0. Divisions are stored
+ *        with the context in every build but only played with
+ *        CLOCK_DIVIDER. The full-gate recorder still watches AC0 STATE
+ *
+ */
+
+#ifndef CLOCK_H
+#define	CLOCK_H
+
+/* uncomment to filter and divide the gate clock in hardware (see above) */
+//#define CLOCK_DIVIDER
+
+#define CLOCK_DIV_MAX       8       // gate edges per step, at most
+#define CLOCK_AC_HYSMODE    AC_HYSMODE_50mV_gc
+#define CLOCK_POT_SLOT      7       // ADC0_value slot of the division pot (AIN7)
+#define CLOCK_POT_HYST      (1 << (ADC_RESULT_BITS - 8))    // pot noise, in codes
+#define CLOCK_POT_SETTLE    16      // CV results polled at boot; twice the
+                                    // pot's rate in ADC_SCAN_RATES
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void clock_init(void);
+void clock_setDiv(uint8_t);
+void clock_service(void);
+bool clock_busy(void);
+
+#endif	/* CLOCK_H */
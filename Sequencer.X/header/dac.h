@@ -0,0 +1,50 @@
+/*
+ * File:   dac.h
+ * Author: N Mark
+ *
+ * Optional dedicated DAC bus: the MCP4922 on USART1 in host SPI mode
+ * instead of sharing SPI0 with the flash.
+ *
+ * A frame is two writes into the USART's buffered transmitter; dac_write
+ * returns while the bytes are still shifting and the transmit complete
+ * ISR raises the chip select, which latches the output (LDAC tied low).
+ * Flash streams on SPI0 are never preempted, so DAC updates and flash
+ * transfers run in parallel.
+ *
+ * Wiring with DAC_USART (USART1 default route):
+ *      - PC0 = TxD -> MCP4922 SDI   (was PE0, SPI0 MOSI)
+ *      - PC2 = XCK -> MCP4922 SCK   (was PE2, SPI0 SCK)
+ *      - PE3 = chip select, unchanged
+ *      - saveContext button moves from PC0 to PC1 (RxD, receiver unused)
+ *
+ * @NOTE: A frame requested while the previous one is still shifting waits
+ *        for it (2 bytes, 32 CLK_PER at DAC_SCK_HZ), so back-to-back
+ *        frames are no faster than on SPI0; what is gained is the caller's
+ *        time and the flash stream restarts. bench_spi measures both
+ *
+ */
+
+#ifndef DAC_H
+#define	DAC_H
+
+/*
+ * uncomment to drive the DAC over USART1 (see above); the board has to be
+ * wired for it
+ */
+//#define DAC_USART
+
+#define DAC_SCK_HZ          (F_CPU / 2)     // fastest host SPI clock
+/* host SPI BAUD: CLK_PER / (2 * BAUD[15:6]) */
+#define DAC_BAUD            ((uint16_t)(F_CPU / (2 * DAC_SCK_HZ)) << 6)
+#define DAC_CS_bm           PIN3_bm         // on PORTE, SPI0_DAC_SS
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void dac_init(void);
+void dac_write(uint8_t, uint8_t);
+void dac_txc(void);
+bool dac_busy(void);
+
+#endif	/* DAC_H */
@@ -0,0 +1,49 @@
+/*
+ * File:   events.h
+ * Author: N Mark
+ *
+ * Deferred work for the front panel. The port ISRs only capture the pin
+ * state and post an event; the main loop drains the queues, highest
+ * priority first, and does the actual work.
+ *
+ * @NOTE: Every queue is single-producer/single-consumer and lock-free. The
+ *        producer is the level 0 port ISRs, which never nest each other;
+ *        the consumer is the main loop. The level 1 gate ISR MUST NOT post
+ *
+ */
+
+#ifndef EVENTS_H
+#define	EVENTS_H
+
+#define EVT_QUEUE_SIZE      8       // entries per queue, power of 2
+
+/* queue priorities, drained lowest number first */
+#define EVT_PRIO_PANEL      0       // step/mode buttons, encoder
+#define EVT_PRIO_BULK       1       // flash work (save context)
+#define EVT_PRIOS           2
+
+/* event types */
+#define EVT_STEP_BUTTONS    1       // data: pressed step buttons (~PORTA.IN)
+#define EVT_ENCODER         2       // data: encoder pins (PORTB.IN)
+#define EVT_PLAYBACK_BUTTON 3       // data: PORTD.IN (press and release)
+#define EVT_RECORD_BUTTON   4
+#define EVT_SAVE_BUTTON     5
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+typedef struct event {
+    
+    uint8_t type;       // EVT_* type
+    uint8_t data;       // pin state captured by the ISR
+    
+} event_t;
+
+bool evt_post(uint8_t, uint8_t, uint8_t);
+bool evt_get(event_t *);
+bool evt_pending(void);
+uint8_t evt_dropped(void);
+
+#endif	/* EVENTS_H */
+
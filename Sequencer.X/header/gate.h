@@ -0,0 +1,60 @@
+/*
+ * File:   gate.h
+ * Author: N Mark
+ *
+ * Per-step gate and trigger outputs timed by the TCB single-shot mode.
+ *
+ * On a step that plays, the clock ISR only arms the two timers (a software
+ * event through EVSYS_GATE_CHANNEL); each TCB raises its pin when started
+ * and drops it by itself at CCMP, so there is no pulse-end interrupt and a
+ * busy CPU cannot stretch or shorten a pulse.
+ *      - gate    (PF4, TCB0 WO alt.): step's gate % of the clock period
+ *      - trigger (PF5, TCB1 WO alt.): GATE_TRIG_US on every played step
+ *
+ * TCA0 free-runs as the timebase: the TCBs count its ticks (CLKTCA) and
+ * the clock period is the tick count between two clock edges.
+ *
+ * A gate still high at the next played step is restarted, not ended. At
+ * 100% the gate is programmed a quarter period (GATE_TIE_SLACK) past the
+ * next edge, so a clock arriving late by the ISR latency or a tick of
+ * measurement still finds it high and ties the steps; after a rest or a
+ * stop it ends there. Rests play no pulses. The pot on AIN5 (PD5)
+ * sets the gate of the step last touched with a step button.
+ *
+ * @NOTE: An interval longer than a TCA0 wrap (65536 ticks, ~5s), i.e. a
+ *        stopped or very slow clock, keeps the last measured period. The
+ *        first clock after boot has none and plays no pulses
+ *
+ */
+
+#ifndef GATE_H
+#define	GATE_H
+
+/* uncomment to drive the gate and trigger outputs on PF4/PF5 (see above) */
+//#define GATE_OUTPUT
+
+#define GATE_DEFAULT        50      // % of the clock period, factory setting
+#define GATE_MIN            5       // % at the pot's low end
+#define GATE_MAX            100     // ties to the next step
+#define GATE_TIE_SLACK      2       // a tie runs period >> 2 past the next edge
+#define GATE_TRIG_US        1000    // trigger pulse width
+#define GATE_POT_SLOT       5       // ADC0_value slot of the gate pot (AIN5)
+#define GATE_POT_HYST       (1 << (ADC_RESULT_BITS - 8))    // pot noise, in codes
+#define GATE_POT_SETTLE     16      // CV results polled at boot; twice the
+                                    // pot's rate in ADC_SCAN_RATES
+#define EVSYS_GATE_CHANNEL  2       // software event, strobed to TCB0/TCB1
+
+/* TCA0 prescaler: CLK_PER / 256, 76.8us per tick */
+#define GATE_TICK_DIV       256
+#define GATE_TRIG_TICKS     ((uint16_t)((uint32_t)GATE_TRIG_US * (F_CPU / 1000) / ((uint32_t)GATE_TICK_DIV * 1000)))
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void gate_init(void);
+void gate_clock(bool);
+void gate_service(void);
+bool gate_busy(void);
+
+#endif	/* GATE_H */
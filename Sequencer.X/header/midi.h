@@ -0,0 +1,69 @@
+/*
+ * File:   midi.h
+ * Author: N Mark
+ *
+ * MIDI clock and transport input on USART2 RxD (PF1, 31250 baud, 8N1).
+ *
+ * midi_rx() is a running-status parser with a constant cost per byte and
+ * no buffers: real-time bytes act at once, every other message is only
+ * counted through (channel messages are skipped, SysEx is dropped).
+ *      - 0xF8 clock:    a step every MIDI_CLOCKS_PER_STEP clocks while
+ *                       running
+ *      - 0xFA start:    the next clock plays the first step
+ *      - 0xFB continue: the next step due is played from the position
+ *      - 0xFC stop:     clocks are ignored, the position is kept
+ *      - 0xF2 song position: moves a stopped sequencer; the step walk is
+ *                       done by midi_service() in the main loop
+ *
+ * @NOTE: With MIDI_INPUT the MIDI receiver is the level 1 interrupt and
+ *        the gate ISR is disabled (AC0 still feeds the full-gate recorder),
+ *        so MIDI is the only clock. Song chaining counts MIDI steps like
+ *        gates; song position ignores it
+ *
+ */
+
+#ifndef MIDI_H
+#define	MIDI_H
+
+/* uncomment to clock the sequencer from MIDI on PF1 (see above) */
+//#define MIDI_INPUT
+
+/*
+ * uncomment (with MIDI_INPUT) to measure the time from the start bit of a
+ * step's 0xF8 to the end of its DAC update. PF1 edges are captured by
+ * TCB3 through event channel 5; min/max/mean are printed via USART3 every
+ * MIDI_JITTER_CLOCKS steps. Cannot be used with PWR_LATENCY or
+ * TRACE_CAPTURE, which also use TCB3
+ */
+//#define MIDI_JITTER
+
+#define MIDI_BAUD_RATE      31250
+#define MIDI_BAUD           ((uint16_t)(((float)F_CPU * 64 / (16 * (float)MIDI_BAUD_RATE)) + 0.5))
+#define MIDI_CLOCKS_PER_STEP 6      // 24 PPQN: a step per 16th note, the
+                                    // unit of a song position
+#define MIDI_JITTER_CLOCKS  96      // steps per jitter report
+
+/* midi_rx results */
+#define MIDI_STEP           0x01    // a step is due
+#define MIDI_RESTART        0x02    // ... and it is the first one after start
+
+/* messages */
+#define MIDI_CLOCK          0xF8
+#define MIDI_START          0xFA
+#define MIDI_CONTINUE       0xFB
+#define MIDI_STOP           0xFC
+#define MIDI_SONG_POSITION  0xF2
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void midi_init(void);
+uint8_t midi_rx(uint8_t);
+void midi_stamp(void);
+void midi_service(void);
+bool midi_pending(void);
+bool midi_busy(void);
+void midi_report(void);
+
+#endif	/* MIDI_H */
@@ -0,0 +1,39 @@
+/*
+ * File:   player.h
+ * Author: N Mark
+ *
+ * Streaming playback of full-gate recordings (see recorder.h). A TCB2 tick
+ * at REC_SAMPLE_RATE feeds the DAC from a double buffer that play_service()
+ * refills from the step's flash slot with sequential Fast Read bursts.
+ *
+ * @NOTE: Playback is keyed to the step that owns the recording; the step's
+ *        one-shot value (the first recorded sample) goes out on the gate
+ *        edge and the stream follows once the first half is loaded
+ *
+ */
+
+#ifndef PLAYER_H
+#define	PLAYER_H
+
+/* player states */
+#define PLAY_IDLE           0
+#define PLAY_LOAD           1       // waiting for the first half
+#define PLAY_RUN            2       // tick is streaming
+
+/* uncomment to print the sustainable playback rate on boot */
+//#define PLAY_BENCHMARK
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void play_start(uint8_t, uint8_t);
+void play_stop(void);
+void play_tick(void);
+void play_service(void);
+bool play_busy(void);
+bool play_pending(void);
+void play_benchmark(void);
+
+#endif	/* PLAYER_H */
+
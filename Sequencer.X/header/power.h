@@ -0,0 +1,51 @@
+/*
+ * File:   power.h
+ * Author: N Mark
+ *
+ * Event-driven main loop. The loop runs the flash services and sleeps
+ * whenever none of them has work pending; every interrupt wakes it.
+ *
+ * The ADC scan runs only while something reads it (free run, a recording
+ * armed or running, the gate or division pot); otherwise pwr_sleep pauses
+ * it, so it neither wakes the idle CPU on every result nor has a
+ * conversion aborted by standby.
+ *
+ * @NOTE: Standby is only used in pattern playback mode with no recording
+ *        armed and the TCB2 tick stopped, i.e. when the gate ISR needs
+ *        neither a fresh CV sample (the ADC scan is paused) nor a running
+ *        sample tick. In standby only the gate (AC0), the encoder
+ *        (both edges) and the buttons on the fully asynchronous pins
+ *        PA2, PA6 and PF2 wake the CPU; presses on the other buttons are
+ *        lost, so standby is opt-in via PWR_SLEEP_DEEPEST
+ *
+ */
+
+#ifndef POWER_H
+#define	POWER_H
+
+/* sleep levels */
+#define PWR_AWAKE           0
+#define PWR_IDLE            1
+#define PWR_STANDBY         2
+#define PWR_LEVELS          3
+
+#define PWR_SLEEP_DEEPEST   PWR_IDLE    // deepest level pwr_sleep may use
+
+/*
+ * uncomment to measure the gate wake-up latency per sleep level; AC0_OUT
+ * is routed through event channel 0 to a TCB3 capture and compared with
+ * the timestamp at AC0 ISR entry. New maxima are printed via USART3
+ */
+//#define PWR_LATENCY
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void pwr_init(void);
+void pwr_sleep(void);
+void pwr_wakeStamp(void);
+void pwr_report(void);
+
+#endif	/* POWER_H */
+
@@ -0,0 +1,47 @@
+/*
+ * File:   recorder.h
+ * Author: N Mark
+ *
+ * Full-gate CV recording. While the gate is high the CV input is sampled at
+ * REC_SAMPLE_RATE into a double-buffered SRAM ring; each full half is written
+ * to external flash as one 256 byte page program by rec_service().
+ *
+ * @NOTE: Every step owns an equal slot from MEM_REC_ADDR to the end of the
+ *        flash, sized at rec_init from the probed capacity. The first page
+ *        of a slot holds the sample count (0xFFFF while empty), the samples
+ *        (big endian) follow from the second page on. Slots shrink as
+ *        NUM_STEPS grows (32KB at 8 steps, 4KB at 64 on the W25Q32JV) and are
+ *        capped at REC_SLOT_MAX, the most a 16 bit sample count can fill
+ *
+ */
+
+#ifndef RECORDER_H
+#define	RECORDER_H
+
+#define REC_SAMPLE_RATE     1000    // samples per second (TCB2 tick)
+#define REC_BUF_SAMPLES     (MEM_PAGE_SIZE / 2)     // samples per ring half
+#define REC_SLOT_MAX        0x20000UL   // 128KB, 65408 samples
+#define REC_EMPTY           0xFFFF  // sample count of an erased slot
+
+/* recorder states */
+#define REC_IDLE            0
+#define REC_RUN             1       // sampling; halves written as they fill
+#define REC_STOP            2       // gate went low, flushing the last half
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+void rec_init(void);
+void rec_start(uint8_t, uint8_t);
+void rec_tick(void);
+void rec_service(void);
+uint32_t rec_slotAddr(uint8_t, uint8_t);
+bool rec_recorded(uint8_t, uint8_t);
+bool rec_patternRecorded(uint8_t);
+bool rec_busy(void);
+bool rec_pending(void);
+void rec_clear(void);
+
+#endif	/* RECORDER_H */
+
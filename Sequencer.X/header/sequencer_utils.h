@@ -18,15 +18,65 @@
 
 #define F_CPU           3333333 // for util/delay.h
 #define NUM_PATTERNS    8
-#define NUM_STEPS       8
+#ifndef NUM_STEPS
+#define NUM_STEPS       8       // 8, 16, 32 or 64; may be set with -DNUM_STEPS
+#endif
 #define CONTEXT_PARAMS  10      // number of parameters to context store/restore
 
+#if NUM_STEPS != 8 && NUM_STEPS != 16 && NUM_STEPS != 32 && NUM_STEPS != 64
+#error "NUM_STEPS must be 8, 16, 32 or 64"
+#endif
+
+/* step pages: the 8 step buttons and LEDs show one page of steps at a time */
+#define PAGE_STEPS      8
+#define NUM_PAGES       (NUM_STEPS / PAGE_STEPS)
+#define STEP_PAGE(s)    ((s) >> 3)              // page of step s
+#define STEP_BIT(s)     (1 << ((s) & 0x07))     // bit of step s in its page
+#define STEP_ENABLED(pat, s) ((pat)->enable[STEP_PAGE(s)] & STEP_BIT(s))
+
+/* 
+ * saveContext()/restoreContext() layout, as offsets into each of the two 
+ * copies (MEM_CONTEXT_ADDR and MEM_CONTEXT_B_ADDR). The trailer is written 
+ * last: sequence number, CRC of status, steps and sequence number, magic
+ */
+#define CONTEXT_STATUS      0x000100
+#if NUM_STEPS == 8
+#define CONTEXT_STEPS       0x000000    // one page, below the status
+#else
+#define CONTEXT_STEPS       0x000200
+#endif
+#define CONTEXT_TRAILER     0x0001FA    // last 6 bytes of the status page
+#define CONTEXT_MAGIC       0xC07E
+
+/* playback modes (status.patternMode) */
+#define STEP_MODE_FORWARD   0
+#define STEP_MODE_BACKWARD  1
+#define STEP_MODE_PINGPONG  2
+#define STEP_MODE_RANDOM    3
+#define STEP_MODE_WALK      4       // random walk, one step either way
+#define STEP_MODE_EUCLID    5       // enabled steps spread over NUM_STEPS gates
+#define STEP_MODES          6
+#define STEP_REST           0xFF    // play order entry for a Euclidean rest
+
 #include <util/delay.h>
 #include "spi.h"
 #include "adc.h"
 #include "terminalPrint.h"
 #include "ac.h"
 #include "W25Q32JV_memory.h"
+#include "calibration.h"
+#include "recorder.h"
+#include "player.h"
+#include "bench.h"
+#include "power.h"
+#include "events.h"
+#include "song.h"
+#include "stack.h"
+#include "trace.h"
+#include "dac.h"
+#include "midi.h"
+#include "gate.h"
+#include "clock.h"
 
 
 /*
@@ -44,38 +94,53 @@ volatile uint16_t adcVal; // word read from ADC conversion
  */
 typedef struct step {
     
-    bool enable;        // when disabled, step is skipped (alters pattern length)
     uint16_t value;     // one shot sample stored in steps value
-    uint8_t repeat;     // step repeat variable (currently 3 repeats supported)
-    uint8_t counter;    // counter is a duplicate/countdown variable for repeat
+    uint8_t repeat;     // step repeat variable (currently 3 repeats supported);
+                        // counted down by step() for the current step only
+    uint8_t gate;       // gate output length, % of the clock period (gate.h)
     
 } step_t;
 
 typedef struct step_pattern {
     
     step_t steps[NUM_STEPS];    // each pattern has NUM_STEPS steps in an array
+    uint8_t enable[NUM_PAGES];  // enable bitmap, one byte per page (STEP_ENABLED);
+                                // disabled steps are skipped (alters pattern length)
     uint8_t idx;                // useful index attribute for patterns array
+    uint8_t clockDiv;           // gate edges per step (clock.h)
     uint8_t seqLength;          // sequence length is altered often;
-                                // can be larger than 8 with repeats (up to 24 currently)
+                                // up to 3 * NUM_STEPS with repeats
     
 } step_pattern_t;
 
 typedef struct seq_status {
     
     bool freeRun;           // true: freeRun mode; false: pattern playback mode
+    bool songMode;          // pattern playback follows the song chain
     bool recordEnable;      // true: record mode; false: no recording
+    bool gateRecord;        // true: record whole gate; false: one-shot only
     bool saved;
     uint8_t currPatternIdx; // variable for the current pattern index
     uint8_t currStepIdx;    // variable for the current step index
-    uint8_t patternMode;    // modes include forward and backwards traversal of pattern]
+    uint8_t patternMode;    // STEP_MODE_* traversal of the pattern
+    uint8_t page;           // step page on the buttons and LEDs
     
 } seq_status_t;
 
+typedef struct step_order {
+    
+    uint8_t mode;                   // STEP_MODE_* the order was built for
+    uint8_t len;                    // entries in idx
+    uint8_t idx[2 * NUM_STEPS];     // step indices (or STEP_REST) in play order
+    
+} step_order_t;
+
 /*
 -------------------------------------------------------------------------------
  Structure instantiations:
  patterns[]:    contains all sequencer patterns
- *currPattern:  pointer to current pattern
+ *currPattern:  pattern played by the gate ISR; a published copy of
+                patterns[status.currPatternIdx] (see publishPattern)
  status:        status contains sequencer status and count variables
 -------------------------------------------------------------------------------
  */
@@ -89,23 +154,40 @@ seq_status_t status;
 void io_init(void);
 void rtc_pit_init(void);
 void sequencer_init(void);
-void selectPattern(void);
+void selectPattern(uint8_t);
 void freeRunSample(void);
-void freeSampleOnGate(void);
 uint16_t oneShotSample(void);
 void setRecordEnable(void);
 void setPlaybackEnable(void);
 void playbackPattern(void);
 void recordSample(uint16_t);
 void sendDacCommand(uint16_t);
-void step(void);
-void toggleSteps(void);
+void sendDacRaw(uint16_t);
+bool step(void);
+void buildOrder(step_pattern_t *, uint8_t, step_order_t *);
+uint16_t passGates(uint8_t);
+void setPatternMode(uint8_t);
+void publishPattern(void);
+void stagePattern(uint8_t, bool);
+bool releasePattern(void);
+void swapPattern(void);
+bool restartPattern(void);
+void seekPattern(uint16_t);
+void loadPattern(void);
+void toggleSteps(uint8_t);
+void setStepGate(uint8_t);
+void setClockDiv(uint8_t);
 void saveContext(void);
 void restoreContext(void);
+void factoryReset(void);
+void handleEvent(event_t *);
 void recLedToggle(bool);
 void playbackLedToggle(bool);
 void stepLedsToggle(bool);
-void rotaryTwist(bool);
+void rotaryTwist(uint8_t, bool);
+void turnPage(uint8_t);
+void playbackButton(uint8_t);
+void showStep(void);
 
 
 #endif	/* SEQUENCER_UTILS_H */
\ No newline at end of file
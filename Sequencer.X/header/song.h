@@ -0,0 +1,46 @@
+/*
+ * File:   song.h
+ * Author: N Mark
+ *
+ * Song mode. An ordered chain of patterns, each played a number of times,
+ * is stored at MEM_SONG_ADDR on the external flash. The gate ISR counts
+ * gates down to the end of the current entry; SONG_PREFETCH_STEPS gates
+ * before that, the main loop stages the next entry's pattern in the
+ * shadow buffer (see publishPattern), held until the boundary gate
+ * releases it, so the switch lands exactly on the downbeat.
+ *
+ * @NOTE: The chain is entered over USART3 when the record button (PF2) is
+ *        held during power-up; song_init() loads it otherwise
+ *
+ */
+
+#ifndef SONG_H
+#define	SONG_H
+
+#define SONG_MAX_ENTRIES    32
+#define SONG_MAGIC          0x50C5  // marks a valid chain in flash
+#define SONG_PREFETCH_STEPS 2       // gates before the boundary the next pattern is staged
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+typedef struct song_entry {
+    
+    uint8_t pattern;    // index into patterns[]
+    uint8_t repeats;    // passes through the pattern before moving on
+    
+} song_entry_t;
+
+void song_init(void);
+void song_edit(void);
+void song_load(void);
+void song_store(void);
+bool song_start(void);
+void song_stop(void);
+bool song_tick(void);
+void song_service(void);
+bool song_pending(void);
+
+#endif	/* SONG_H */
+
@@ -16,8 +16,53 @@
 #ifndef _SPI_H
 #define	_SPI_H_
 
+#include <stdbool.h>
 #include <avr/io.h>
 
+/*! @brief Slave select addresses (see SPI0_select)
+ */
+#define SPI0_FLASH_SS   0x23    // W25Q32JV chip select on PC3
+#define SPI0_DAC_SS     0x43    // MCP4922 chip select on PE3
+
+/*! @brief Shared bus arbitration
+ * 
+ *  The DAC and the flash share SPI0. Every byte is shifted with interrupts
+ *  disabled, so a DAC frame requested from an interrupt can only ever start
+ *  on a byte boundary. Flash transactions are opened as streams; a DAC frame
+ *  arriving while a stream is open raises the stream's chip select, marks it
+ *  preempted and goes out immediately. The stream owner notices on its next
+ *  byte (SPI0_streamByte returns false) and re-issues its command header at
+ *  the address it stopped at.
+ * 
+ *  Worst-case DAC latency, from the interrupt request to the first DAC clock:
+ *  the longest atomic bus step, i.e. a DAC frame already on the bus (two
+ *  bytes = 32 CLK_PER, 9.6us with the default DAC profile; a flash byte is
+ *  half that at its default), plus the interrupt response and whatever the
+ *  ISR does before the frame.
+ *  This holds for frames sent from the AC0 ISR, which is the level 1
+ *  interrupt, and from the main loop; level 0 ISRs still wait behind other
+ *  level 0 ISRs.
+ */
+
+/*! @brief Per-slave bus profiles
+ * 
+ *  Each slave registered with SPI0_profile gets its own clock (SPI_PRESC_gm
+ *  and SPI_CLK2X_bm of CTRLA) and mode (SPI_MODE_gm of CTRLB). SPI0_select
+ *  applies the slave's profile before pulling its chip select low, so every
+ *  transaction, a DAC frame preempting a stream included, runs at its own
+ *  device's speed. Slaves without a profile use the SPI0_init settings.
+ * 
+ *  The defaults are the fastest the prescaler allows, CLK_PER / 2
+ *  (1.67MHz), well inside both parts' limits (MCP4922 20MHz, W25Q32JV 50MHz
+ *  for Read, 133MHz otherwise); slow them down here if the wiring needs it.
+ *  Both parts take mode 0 (and 3).
+ */
+#define SPI0_PROFILES       4
+#define SPI0_DAC_CLOCK      (SPI_PRESC_DIV4_gc | SPI_CLK2X_bm)
+#define SPI0_DAC_MODE       SPI_MODE_0_gc
+#define SPI0_FLASH_CLOCK    (SPI_PRESC_DIV4_gc | SPI_CLK2X_bm)
+#define SPI0_FLASH_MODE     SPI_MODE_0_gc
+
 /*! @brief Configuration structure for PORTC SPI initialization
  */ 
 PORT_t spi_port_config;
@@ -37,7 +82,8 @@ void SPI0_init(uint8_t);
  * 
  *  Writes data to be transmitted over the SPI0 lane to the SPIx.DATA register. \n
  *  Then waits for data to be successfully transmitted before returning. If the \n
- *  transmission is successful, SPIx.DATA will return '0x00'.
+ *  transmission is successful, SPIx.DATA will return '0x00'. \n
+ *  The byte is shifted with interrupts disabled.
  * 
  *  @param[in]  data : the byte to be transmitted
  *  @return     (uint8_t)SPIx.DATA
@@ -58,6 +104,59 @@ uint8_t SPI0_transmit(uint8_t);
  * @return  none   
  */
 void SPI0_select(uint8_t, uint8_t);
+/*! @brief Configures a slave select pin as an output, deselected
+ * 
+ * @param[in]    addr : the address of the slave
+ * @return  none   
+ */
+void SPI0_slaveInit(uint8_t);
+/*! @brief Sets the clock and mode used for a slave
+ * 
+ *  Takes effect on the slave's next select. At most SPI0_PROFILES slaves;
+ *  further ones are ignored and keep the SPI0_init settings.
+ * 
+ * @param[in]    addr : the address of the slave
+ *               clock : SPI_PRESC_xxx_gc, optionally with SPI_CLK2X_bm
+ *               mode : SPI_MODE_x_gc
+ * @return  none   
+ */
+void SPI0_profile(uint8_t, uint8_t, uint8_t);
+/*! @brief Returns the CLK_PER cycles one byte takes with a slave's profile
+ * 
+ * @param[in]    addr : the address of the slave
+ * @return  CLK_PER cycles per byte   
+ */
+uint16_t SPI0_byteClocks(uint8_t);
+/*! @brief Opens a preemptible transaction and selects its slave
+ * 
+ * @param[in]    addr : the address of the slave
+ * @return  none   
+ */
+void SPI0_streamOpen(uint8_t);
+/*! @brief Shifts one byte of an open transaction
+ * 
+ *  Checks for preemption and shifts the byte as one atomic step.
+ * 
+ * @param[in]    data : the byte to be transmitted
+ * @param[out]   rx : the byte received
+ * @return  false if a DAC frame preempted the transaction; nothing was sent   
+ */
+bool SPI0_streamByte(uint8_t, uint8_t*);
+/*! @brief Returns true if the open transaction has been preempted
+ */
+bool SPI0_streamPreempted(void);
+/*! @brief Closes the open transaction and deselects its slave
+ * 
+ * @return  false if a DAC frame preempted the transaction since it was opened   
+ */
+bool SPI0_streamClose(void);
+/*! @brief Sends a 16-bit frame to the DAC with priority over any stream
+ * 
+ * @param[in]    high : first byte of the frame
+ *               low : second byte of the frame
+ * @return  none   
+ */
+void SPI0_dacWrite(uint8_t, uint8_t);
 
 #endif	/* _SPI_H_ */
 
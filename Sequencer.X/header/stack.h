@@ -0,0 +1,71 @@
+/*
+ * File:   stack.h
+ * Author: N Mark
+ *
+ * Stack high-water mark and per-ISR stack depth.
+ *
+ * Before main, everything from the end of .data/.bss (_end) up to RAMEND
+ * is painted with STACK_PAINT. The stack grows down into the paint, so the
+ * lowest byte that no longer holds it marks the deepest the stack has been.
+ *
+ * @NOTE: A pushed byte that happens to equal STACK_PAINT at the very bottom
+ *        of the deepest frame is counted as unused, so the mark can be a
+ *        byte or two low. There is no heap; nothing else writes above _end
+ *
+ */
+
+#ifndef STACK_H
+#define	STACK_H
+
+#define STACK_PAINT         0xC5
+
+/*
+ * uncomment to sample SP on entry of every ISR and print new maxima of
+ * the high-water mark and of each ISR's depth via USART3
+ */
+//#define STACK_MONITOR
+
+/* ISRs sampled by STACK_SAMPLE */
+#define STACK_ISR_AC0       0
+#define STACK_ISR_RTC       1
+#define STACK_ISR_ADC0      2
+#define STACK_ISR_TCB2      3
+#define STACK_ISR_PORTA     4
+#define STACK_ISR_PORTB     5
+#define STACK_ISR_PORTC     6
+#define STACK_ISR_PORTD     7
+#define STACK_ISR_PORTF     8
+#define STACK_ISR_TCB3      9
+#define STACK_ISR_USART1    10
+#define STACK_ISR_USART2    11
+#define STACK_ISR_TCA0      12
+#define STACK_ISRS          13
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+extern volatile uint16_t stackIsrDepth[STACK_ISRS];
+
+/*
+ * Records the stack depth (bytes below RAMEND, the ISR's own prologue
+ * included) at the point of use; first statement of every ISR. The depth
+ * of the level 1 gate ISR includes any level 0 ISR it preempted
+ */
+#ifdef STACK_MONITOR
+#define STACK_SAMPLE(isr) do { \
+        uint16_t depth = RAMEND - SP; \
+        if (depth > stackIsrDepth[isr]) { \
+            stackIsrDepth[isr] = depth; \
+        } \
+    } while (0)
+#else
+#define STACK_SAMPLE(isr) do { } while (0)
+#endif
+
+uint16_t stack_highWater(void);
+uint16_t stack_size(void);
+void stack_report(void);
+
+#endif	/* STACK_H */
+
@@ -29,8 +29,10 @@ void USART3_sendChar(char c);
 void USART3_sendString(char *str);
 void USART3_sendByte(uint8_t);
 void USART3_sendNum(uint8_t);
+void USART3_sendWord(uint16_t);
 void USART3_sendHex(uint8_t);
 uint8_t USART3_read();
+uint16_t USART3_readNum();
 
 #endif	/* TERMINALPRINT_H */
 
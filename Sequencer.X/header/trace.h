@@ -0,0 +1,81 @@
+/*
+ * File:   trace.h
+ * Author: N Mark
+ *
+ * Event trace for replaying field issues on the host (host/replay).
+ *
+ * Every gate edge, button/encoder pin change and CV sample the firmware
+ * acts on is stamped with the TCB3 time and kept in a RAM ring. The main
+ * loop streams the ring over USART3, between the text output, as 6 byte
+ * frames:
+ *
+ *     0xA5, type, data, dt low, dt high, XOR of type to dt high
+ *
+ * dt is the TCB3 ticks since the previous record. A gap longer than dt
+ * can hold is put in a TRACE_GAP record first, in units of 65536 ticks.
+ *
+ * @NOTE: TCB3 is extended past its wrap by an interrupt, so TRACE_CAPTURE
+ *        and PWR_LATENCY (TCB3 capture) exclude each other. A record that
+ *        finds the ring full is dropped; the next one that fits is preceded
+ *        by a TRACE_LOST record with the count. Full-gate recording traces
+ *        a CV sample per tick, more than 115200 baud can stream
+ *
+ */
+
+#ifndef TRACE_H
+#define	TRACE_H
+
+/*
+ * uncomment to capture the event trace and stream it over USART3
+ */
+//#define TRACE_CAPTURE
+
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS       64      // ring entries, power of 2 up to 128
+#endif
+#define TRACE_SYNC          0xA5    // first byte of a frame; text is ASCII
+
+/* record types */
+#define TRACE_GAP           0x00    // dt: 65536 tick periods before the next
+#define TRACE_LOST          0x01    // data: records dropped before this one
+#define TRACE_START         0x02    // data: NUM_STEPS of the firmware
+#define TRACE_GATE          0x03    // data: 1 AC0 rising edge (TCA0 overflow
+                                    // with CLOCK_DIVIDER), 0 gate seen low
+#define TRACE_PORTA         0x04    // data: PORTx.IN read by the port ISR
+#define TRACE_PORTB         0x05
+#define TRACE_PORTC         0x06
+#define TRACE_PORTD         0x07
+#define TRACE_PORTF         0x08
+#define TRACE_MIDI          0x09    // data: byte received by the MIDI ISR
+#define TRACE_GATE_POT      0x0A    // data: gate % set by the gate pot
+#define TRACE_DIV_POT       0x0B    // data: division set by the division pot
+#define TRACE_ADC           0x80    // CV sample; bits 6:0 are its bits 14:8,
+                                    // data its low byte
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+typedef struct trace_rec {
+    
+    uint8_t type;       // TRACE_* type
+    uint8_t data;
+    uint16_t dt;        // ticks since the previous record
+    
+} trace_rec_t;
+
+#ifdef TRACE_CAPTURE
+#define TRACE_EVENT(type, data)     trace_record(type, data)
+#define TRACE_SAMPLE(val)           trace_record(TRACE_ADC | (((val) >> 8) & 0x7F), (val) & 0xFF)
+#else
+#define TRACE_EVENT(type, data)     do { } while (0)
+#define TRACE_SAMPLE(val)           do { } while (0)
+#endif
+
+void trace_init(void);
+void trace_wrap(void);
+void trace_record(uint8_t, uint8_t);
+void trace_service(void);
+bool trace_pending(void);
+
+#endif	/* TRACE_H */
@@ -0,0 +1,20 @@
+/*
+ * File:   interrupt.h
+ * Author: N Mark
+ *
+ * Host stand-in for <avr/interrupt.h>. There are no interrupts on the host;
+ * sei()/cli() only keep the I bit of SREG so SREG save/restore still works.
+ *
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define	HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define sei()   (SREG |= CPU_I_bm)
+#define cli()   (SREG &= ~CPU_I_bm)
+
+#define ISR(vector, ...)    void vector(void)
+
+#endif	/* HOST_AVR_INTERRUPT_H */
@@ -0,0 +1,285 @@
+/*
+ * File:   io.h
+ * Author: N Mark
+ *
+ * Host stand-in for <avr/io.h>: the ATmega4809 peripherals the firmware
+ * touches, as plain structs in host memory (defined in host.c), with the
+ * bit masks and group codes of the device header.
+ *
+ * @NOTE: Nothing behind a register reacts to a write; only what the host
+ *        build needs to compile and link is here. SPI0 traffic goes through
+ *        host_spi.c, never through these registers
+ *
+ */
+
+#ifndef HOST_AVR_IO_H
+#define	HOST_AVR_IO_H
+
+#include <stdint.h>
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+
+typedef struct PORT_struct {
+    register8_t DIR, DIRSET, DIRCLR, DIRTGL;
+    register8_t OUT, OUTSET, OUTCLR, OUTTGL;
+    register8_t IN, INTFLAGS, PORTCTRL;
+    register8_t PIN0CTRL, PIN1CTRL, PIN2CTRL, PIN3CTRL;
+    register8_t PIN4CTRL, PIN5CTRL, PIN6CTRL, PIN7CTRL;
+} PORT_t;
+
+typedef struct SPI_struct {
+    register8_t CTRLA, CTRLB, INTCTRL, INTFLAGS, DATA;
+} SPI_t;
+
+typedef struct ADC_struct {
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLE, SAMPCTRL, MUXPOS;
+    register8_t COMMAND, EVCTRL, INTCTRL, INTFLAGS, DBGCTRL, TEMP;
+    register16_t RES, WINLT, WINHT;
+    register8_t CALIB;
+} ADC_t;
+
+typedef struct AC_struct {
+    register8_t CTRLA, MUXCTRLA, DACREF, INTCTRL, STATUS;
+} AC_t;
+
+typedef struct VREF_struct {
+    register8_t CTRLA, CTRLB;
+} VREF_t;
+
+typedef struct USART_struct {
+    register8_t RXDATAL, RXDATAH, TXDATAL, TXDATAH, STATUS;
+    register8_t CTRLA, CTRLB, CTRLC;
+    register16_t BAUD;
+    register8_t CTRLD, DBGCTRL, EVCTRL, TXPLCTRL, RXPLCTRL;
+} USART_t;
+
+typedef struct RTC_struct {
+    register8_t CTRLA, STATUS, INTCTRL, INTFLAGS, TEMP, DBGCTRL, CLKSEL;
+    register16_t CNT, PER, CMP;
+    register8_t PITCTRLA, PITSTATUS, PITINTCTRL, PITINTFLAGS, PITDBGCTRL;
+} RTC_t;
+
+typedef struct CLKCTRL_struct {
+    register8_t MCLKCTRLA, MCLKCTRLB, MCLKLOCK, MCLKSTATUS;
+    register8_t OSC20MCTRLA, OSC32KCTRLA, XOSC32KCTRLA;
+} CLKCTRL_t;
+
+typedef struct PORTMUX_struct {
+    register8_t EVSYSROUTEA, CCLROUTEA, USARTROUTEA;
+    register8_t TWISPIROUTEA, TCAROUTEA, TCBROUTEA;
+} PORTMUX_t;
+
+typedef struct TCA_SINGLE_struct {
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLECLR, CTRLESET, CTRLFCLR, CTRLFSET;
+    register8_t EVCTRL, INTCTRL, INTFLAGS, DBGCTRL, TEMP;
+    register16_t CNT, PER, CMP0, CMP1, CMP2;
+    register16_t PERBUF, CMP0BUF, CMP1BUF, CMP2BUF;
+} TCA_SINGLE_t;
+
+typedef union TCA_union {
+    TCA_SINGLE_t SINGLE;
+} TCA_t;
+
+typedef struct TCB_struct {
+    register8_t CTRLA, CTRLB, EVCTRL, INTCTRL, INTFLAGS, STATUS, DBGCTRL, TEMP;
+    register16_t CNT, CCMP;
+} TCB_t;
+
+typedef struct EVSYS_struct {
+    register8_t STROBE;
+    register8_t CHANNEL0, CHANNEL1, CHANNEL2, CHANNEL3;
+    register8_t CHANNEL4, CHANNEL5, CHANNEL6, CHANNEL7;
+    register8_t USERCCLLUT0A, USERCCLLUT0B, USERCCLLUT1A, USERCCLLUT1B;
+    register8_t USERTCA0, USERTCB0, USERTCB1, USERTCB2, USERTCB3;
+    register8_t USEREVOUTF;
+} EVSYS_t;
+
+typedef struct CCL_struct {
+    register8_t CTRLA, SEQCTRL0, SEQCTRL1, INTCTRL0, INTFLAGS;
+    register8_t LUT0CTRLA, LUT0CTRLB, LUT0CTRLC, TRUTH0;
+} CCL_t;
+
+typedef struct SLPCTRL_struct {
+    register8_t CTRLA;
+} SLPCTRL_t;
+
+typedef struct CPUINT_struct {
+    register8_t CTRLA, STATUS, LVL0PRI, LVL1VEC;
+} CPUINT_t;
+
+extern PORT_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF;
+extern SPI_t SPI0;
+extern ADC_t ADC0;
+extern AC_t AC0;
+extern VREF_t VREF;
+extern USART_t USART0, USART1, USART2, USART3;
+extern RTC_t RTC;
+extern CLKCTRL_t CLKCTRL;
+extern PORTMUX_t PORTMUX;
+extern TCA_t TCA0;
+extern TCB_t TCB0, TCB1, TCB2, TCB3;
+extern EVSYS_t EVSYS;
+extern CCL_t CCL;
+extern SLPCTRL_t SLPCTRL;
+extern CPUINT_t CPUINT;
+extern register8_t SREG;
+extern register16_t SP;
+
+#define RAMSTART    0x2800
+#define RAMEND      0x3FFF
+
+/* port */
+#define PIN0_bm     0x01
+#define PIN1_bm     0x02
+#define PIN2_bm     0x04
+#define PIN3_bm     0x08
+#define PIN4_bm     0x10
+#define PIN5_bm     0x20
+#define PIN6_bm     0x40
+#define PIN7_bm     0x80
+#define PORT_ISC_gm                 0x07
+#define PORT_ISC_INTDISABLE_gc      0x00
+#define PORT_ISC_BOTHEDGES_gc       0x01
+#define PORT_ISC_RISING_gc          0x02
+#define PORT_ISC_FALLING_gc         0x03
+#define PORT_ISC_INPUT_DISABLE_gc   0x04
+#define PORT_ISC_LEVEL_gc           0x05
+#define PORT_PULLUPEN_bm            0x08
+#define PORT_INVEN_bm               0x80
+#define PORTMUX_SPI0_DEFAULT_gc     0x00
+#define PORTMUX_SPI0_ALT1_gc        0x01
+#define PORTMUX_SPI0_ALT2_gc        0x02
+#define PORTMUX_USART2_gm           0x30
+#define PORTMUX_USART2_DEFAULT_gc   0x00
+#define PORTMUX_TCB0_bm             0x01
+#define PORTMUX_TCB1_bm             0x02
+
+/* SPI */
+#define SPI_ENABLE_bm       0x01
+#define SPI_PRESC_DIV4_gc   0x00
+#define SPI_PRESC_DIV16_gc  0x02
+#define SPI_PRESC_DIV64_gc  0x04
+#define SPI_PRESC_DIV128_gc 0x06
+#define SPI_PRESC_gm        0x06
+#define SPI_PRESC_gp        1
+#define SPI_MODE_0_gc       0x00
+#define SPI_MODE_1_gc       0x01
+#define SPI_MODE_2_gc       0x02
+#define SPI_MODE_3_gc       0x03
+#define SPI_MODE_gm         0x03
+#define SPI_CLK2X_bm        0x10
+#define SPI_MASTER_bm       0x20
+#define SPI_DORD_bm         0x40
+#define SPI_SSD_bm          0x04
+#define SPI_IF_bm           0x80
+
+/* USART */
+#define USART_RXCIF_bm      0x80
+#define USART_TXCIF_bm      0x40
+#define USART_DREIF_bm      0x20
+#define USART_RXEN_bm       0x80
+#define USART_TXEN_bm       0x40
+#define USART_RXCIE_bm      0x80
+#define USART_CMODE_ASYNCHRONOUS_gc 0x00
+#define USART_PMODE_DISABLED_gc     0x00
+#define USART_SBMODE_1BIT_gc        0x00
+#define USART_CHSIZE_8BIT_gc        0x03
+
+/* ADC */
+#define ADC_ENABLE_bm           0x01
+#define ADC_FREERUN_bm          0x02
+#define ADC_RESSEL_10BIT_gc     0x00
+#define ADC_RESSEL_8BIT_gc      0x04
+#define ADC_SAMPNUM_ACC1_gc     0x00
+#define ADC_SAMPNUM_ACC4_gc     0x02
+#define ADC_SAMPNUM_ACC16_gc    0x04
+#define ADC_SAMPNUM_ACC64_gc    0x06
+#define ADC_PRESC_DIV2_gc       0x00
+#define ADC_PRESC_DIV4_gc       0x01
+#define ADC_REFSEL_INTREF_gc    0x00
+#define ADC_REFSEL_VDDREF_gc    0x10
+#define ADC_MUXPOS_AIN0_gc      0x00
+#define ADC_MUXPOS_AIN1_gc      0x01
+#define ADC_MUXPOS_AIN2_gc      0x02
+#define ADC_MUXPOS_AIN3_gc      0x03
+#define ADC_MUXPOS_AIN4_gc      0x04
+#define ADC_MUXPOS_AIN5_gc      0x05
+#define ADC_MUXPOS_AIN6_gc      0x06
+#define ADC_MUXPOS_AIN7_gc      0x07
+#define ADC_MUXPOS_AIN13_gc     0x0D
+#define ADC_STCONV_bm           0x01
+#define ADC_RESRDY_bm           0x01
+
+/* AC */
+#define AC_ENABLE_bm            0x01
+#define AC_INTMODE_POSEDGE_gc   0x30
+#define AC_RUNSTDBY_bm          0x80
+#define AC_MUXNEG_DACREF_gc     0x03
+#define AC_MUXPOS_PIN2_gc       0x10
+#define AC_CMP_bm               0x01
+#define AC_STATE_bm             0x10
+#define AC_HYSMODE_gm           0x06
+#define AC_HYSMODE_50mV_gc      0x06
+
+/* VREF */
+#define VREF_AC0REFSEL_1V5_gc   0x04
+#define VREF_AC0REFEN_bm        0x02
+
+/* RTC and clock */
+#define RTC_CLKSEL_TOSC32K_gc   0x02
+#define RTC_PRESCALER_DIV1_gc   0x00
+#define RTC_CTRLABUSY_bm        0x01
+#define CLKCTRL_CLKSEL_XOSC32K_gc   0x02
+
+/* TCA */
+#define TCA_SINGLE_ENABLE_bm        0x01
+#define TCA_SINGLE_CLKSEL_DIV1_gc   0x00
+#define TCA_SINGLE_CLKSEL_DIV256_gc 0x0C
+#define TCA_SINGLE_CNTEI_bm         0x01
+#define TCA_SINGLE_EVACT_POSEDGE_gc 0x00
+#define TCA_SINGLE_OVF_bm           0x01
+#define TCA_SINGLE_CMP0_bm          0x10
+
+/* TCB */
+#define TCB_ENABLE_bm           0x01
+#define TCB_CLKSEL_CLKDIV1_gc   0x00
+#define TCB_RUNSTDBY_bm         0x40
+#define TCB_CNTMODE_INT_gc      0x00
+#define TCB_CNTMODE_CAPT_gc     0x02
+#define TCB_CAPTEI_bm           0x01
+#define TCB_CAPT_bm             0x01
+#define TCB_CLKSEL_CLKTCA_gc    0x06
+#define TCB_CNTMODE_SINGLE_gc   0x06
+#define TCB_CCMPEN_bm           0x10
+#define TCB_RUN_bm              0x01
+#define TCB_EDGE_bm             0x10
+
+/* CCL */
+#define CCL_ENABLE_bm           0x01
+#define CCL_FILTSEL_FILTER_gc   0x20
+#define CCL_INSEL0_EVENTA_gc    0x03
+#define CCL_INSEL1_MASK_gc      0x00
+#define CCL_INSEL2_MASK_gc      0x00
+
+/* event system */
+#define EVSYS_CHANNEL_CHANNEL0_gc   0x01
+#define EVSYS_CHANNEL_CHANNEL3_gc   0x04
+#define EVSYS_CHANNEL_CHANNEL4_gc   0x05
+#define EVSYS_CHANNEL_CHANNEL5_gc   0x06
+#define EVSYS_GENERATOR_CCL_LUT0_gc 0x10
+#define EVSYS_GENERATOR_PORT1_PIN1_gc   0x49
+#define EVSYS_GENERATOR_AC0_OUT_gc  0x20
+
+/* sleep controller and CPU */
+#define SLPCTRL_SEN_bm          0x01
+#define SLPCTRL_SMODE_IDLE_gc   0x00
+#define SLPCTRL_SMODE_STDBY_gc  0x02
+#define CPU_I_bm                0x80
+
+/* interrupt vectors */
+#define TCA0_OVF_vect_num       7
+#define AC0_AC_vect_num         21
+#define USART2_RXC_vect_num     31
+
+#endif	/* HOST_AVR_IO_H */
@@ -0,0 +1,20 @@
+/*
+ * File:   pgmspace.h
+ * Author: N Mark
+ *
+ * Host stand-in for <avr/pgmspace.h>; one address space, so flash reads
+ * are plain reads.
+ *
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define	HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+#define PSTR(s)             (s)
+#define pgm_read_byte(p)    (*(const uint8_t *)(p))
+#define pgm_read_word(p)    (*(const uint16_t *)(p))
+
+#endif	/* HOST_AVR_PGMSPACE_H */
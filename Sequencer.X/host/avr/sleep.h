@@ -0,0 +1,16 @@
+/*
+ * File:   sleep.h
+ * Author: N Mark
+ *
+ * Host stand-in for <avr/sleep.h>; sleeping returns at once.
+ *
+ */
+
+#ifndef HOST_AVR_SLEEP_H
+#define	HOST_AVR_SLEEP_H
+
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()
+
+#endif	/* HOST_AVR_SLEEP_H */
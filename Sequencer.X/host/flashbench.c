@@ -0,0 +1,364 @@
+/*
+ * File:   flashbench.c
+ * Author: N Mark
+ *
+ * Runs the firmware's flash paths on the host against the W25Q32JV
+ * emulator: the boot sequence (mem_init, cal/song/rec init and
+ * restoreContext), then saveContext()/restoreContext() round trips with
+ * random patterns. Prints the emulated time of each and the emulator's
+ * counters; a restore that does not give back what was saved, or a pattern
+ * published to the gate ISR that differs from the store, is reported.
+ *
+ * Then torn saves: the newer of two saves is erased, loses its trailer or
+ * has a page of steps cleared (CRC mismatch), and the restore has to give
+ * back the older one. Last, a copy A without a trailer and no copy B (a
+ * context saved before the A/B copies) has to be restored as it is.
+ *
+ * usage: flashbench [-m] [-s MB] [-n saves] [-r seed] image
+ *        -m  maximum instead of typical busy times
+ *        -s  capacity in MB (default 4, the W25Q32JV)
+ *        -n  save/restore round trips (default 16)
+ *        -r  seed of the random patterns
+ *
+ * The image keeps its content between runs, like the part would.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "sequencer_utils.h"
+#include "host.h"
+#include "w25q_emu.h"
+
+/*
+ * local variables
+ */
+static uint64_t t0;
+
+static void start(void) {
+    t0 = host_now();
+}
+
+/* @NAME: stop
+ *
+ * @DESCRIPTION: Returns the emulated time since start() in us
+ *
+ */
+static double stop(void) {
+    return (host_now() - t0) / 1000.0;
+}
+
+/* @NAME: randomize
+ *
+ * @DESCRIPTION: Fills status and patterns[] with random values that
+ *               restoreContext() accepts
+ *
+ */
+static void randomize(void) {
+
+    status.currPatternIdx = rand() % NUM_PATTERNS;
+    status.currStepIdx = rand() % NUM_STEPS;
+    status.freeRun = rand() & 1;
+    status.patternMode = rand() % STEP_MODES;
+    status.recordEnable = rand() & 1;
+
+    for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        patterns[pidx].seqLength = rand() % (3 * NUM_STEPS + 1);
+        patterns[pidx].clockDiv = 1 + rand() % CLOCK_DIV_MAX;
+        for (int page = 0; page < NUM_PAGES; page++) {
+            patterns[pidx].enable[page] = rand();
+        }
+        for (int sidx = 0; sidx < NUM_STEPS; sidx++) {
+            patterns[pidx].steps[sidx].value = rand() & 0x0FFF;
+            patterns[pidx].steps[sidx].repeat = rand() % 3;
+            patterns[pidx].steps[sidx].gate = 1 + rand() % GATE_MAX;
+        }
+    }
+
+}
+
+/* @NAME: same
+ *
+ * @DESCRIPTION: Returns true if the stored fields of status and patterns[]
+ *               match the given copies
+ *
+ */
+static bool same(seq_status_t *st, step_pattern_t *pat) {
+
+    if (status.saved != st->saved || status.currPatternIdx != st->currPatternIdx
+            || status.currStepIdx != st->currStepIdx || status.freeRun != st->freeRun
+            || status.patternMode != st->patternMode
+            || status.recordEnable != st->recordEnable) {
+        return false;
+    }
+
+    for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        if (patterns[pidx].idx != pat[pidx].idx
+                || patterns[pidx].seqLength != pat[pidx].seqLength
+                || patterns[pidx].clockDiv != pat[pidx].clockDiv
+                || memcmp(patterns[pidx].enable, pat[pidx].enable, NUM_PAGES)) {
+            return false;
+        }
+        for (int sidx = 0; sidx < NUM_STEPS; sidx++) {
+            if (patterns[pidx].steps[sidx].value != pat[pidx].steps[sidx].value
+                    || patterns[pidx].steps[sidx].repeat != pat[pidx].steps[sidx].repeat
+                    || patterns[pidx].steps[sidx].gate != pat[pidx].steps[sidx].gate) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+
+}
+
+/* @NAME: live
+ *
+ * @DESCRIPTION: Returns true if the live copy the gate ISR plays
+ *               (currPattern) matches the current pattern of the store
+ *
+ */
+static bool live(void) {
+
+    step_pattern_t *src = &patterns[status.currPatternIdx];
+
+    if (currPattern->idx != src->idx || currPattern->seqLength != src->seqLength
+            || currPattern->clockDiv != src->clockDiv
+            || memcmp(currPattern->enable, src->enable, NUM_PAGES)) {
+        return false;
+    }
+
+    for (int sidx = 0; sidx < NUM_STEPS; sidx++) {
+        if (currPattern->steps[sidx].value != src->steps[sidx].value
+                || currPattern->steps[sidx].repeat != src->steps[sidx].repeat
+                || currPattern->steps[sidx].gate != src->steps[sidx].gate) {
+            return false;
+        }
+    }
+
+    return true;
+
+}
+
+/* @NAME: newest
+ *
+ * @DESCRIPTION: Returns the flash address of the context copy with the
+ *               newer valid trailer (copy A if neither is valid)
+ *
+ */
+static uint32_t newest(void) {
+
+    uint32_t base[2] = {MEM_CONTEXT_ADDR, MEM_CONTEXT_B_ADDR};
+    uint16_t seq[2], magic[2];
+
+    for (int i = 0; i < 2; i++) {
+        mem_readInit(base[i] + CONTEXT_TRAILER);
+        seq[i] = mem_readData() << 8;
+        seq[i] += mem_readData();
+        mem_readData();
+        mem_readData();
+        magic[i] = mem_readData() << 8;
+        magic[i] += mem_readData();
+        mem_readEnd();
+    }
+
+    if (magic[1] == CONTEXT_MAGIC
+            && (magic[0] != CONTEXT_MAGIC || (int16_t)(seq[1] - seq[0]) > 0)) {
+        return base[1];
+    }
+
+    return base[0];
+
+}
+
+/* @NAME: clear
+ *
+ * @DESCRIPTION: Programs len bytes at addr to 0, within one page
+ *
+ */
+static void clear(uint32_t addr, uint16_t len) {
+
+    mem_pageProgramInit(addr);
+    while (len--) {
+        mem_pageProgramData(0);
+    }
+    mem_pageProgramEnd();
+
+}
+
+/* @NAME: torn
+ *
+ * @DESCRIPTION: Damages the newer of two saves in each way a lost power
+ *               or a worn page can, checks that the older one is
+ *               restored, then that a context without a trailer is
+ *               loaded when it is the only one; returns the failures
+ *
+ */
+static unsigned torn(void) {
+
+    static const char *cases[] = {"erased", "no trailer", "bad CRC"};
+    seq_status_t st[2];
+    step_pattern_t pat[2][NUM_PATTERNS];
+    uint32_t base;
+    unsigned bad = 0;
+
+    for (int c = 0; c < 3; c++) {
+        for (int i = 0; i < 2; i++) {
+            randomize();
+            saveContext();
+            st[i] = status;
+            memcpy(pat[i], patterns, sizeof(pat[i]));
+        }
+
+        base = newest();
+        if (c == 0) {
+            mem_sectorErase(base);
+        } else if (c == 1) {
+            clear(base + CONTEXT_TRAILER, 6);
+        } else {
+            clear(base + CONTEXT_STEPS, MEM_PAGE_SIZE);
+        }
+
+        memset(&status, 0, sizeof(status));
+        memset(patterns, 0, sizeof(patterns));
+        restoreContext();
+
+        if (!same(&st[0], pat[0])) {
+            printf("torn save (%s): older copy not restored\n", cases[c]);
+            bad++;
+        }
+    }
+
+    // saved before the A/B copies: copy A alone, without a trailer
+    do {
+        randomize();
+        saveContext();
+    } while (newest() != MEM_CONTEXT_ADDR);
+    st[0] = status;
+    memcpy(pat[0], patterns, sizeof(pat[0]));
+    clear(MEM_CONTEXT_ADDR + CONTEXT_TRAILER, 6);
+    mem_sectorErase(MEM_CONTEXT_B_ADDR);
+
+    memset(&status, 0, sizeof(status));
+    memset(patterns, 0, sizeof(patterns));
+    restoreContext();
+
+    if (!same(&st[0], pat[0])) {
+        printf("context without a trailer not restored\n");
+        bad++;
+    }
+
+    return bad;
+
+}
+
+int main(int argc, char **argv) {
+
+    seq_status_t st;
+    step_pattern_t pat[NUM_PATTERNS];
+    unsigned saves = 16, seed = 1, mb = 4, bad = 0;
+    bool maximum = false;
+    double t, tSave = 0, tSaveMax = 0, tLoad = 0, tLoadMax = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ms:n:r:")) != -1) {
+        switch (opt) {
+            case 'm':
+                maximum = true;
+                break;
+            case 's':
+                mb = strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                saves = strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-m] [-s MB] [-n saves] [-r seed] image\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1 || mb == 0 || (mb & (mb - 1))) {
+        fprintf(stderr, "usage: %s [-m] [-s MB] [-n saves] [-r seed] image\n", argv[0]);
+        return 2;
+    }
+
+    if (!w25q_open(argv[optind], mb << 20, maximum)) {
+        return 1;
+    }
+    srand(seed);
+
+    // no button held at boot
+    PORTA.IN = PORTB.IN = PORTC.IN = PORTD.IN = PORTF.IN = 0xFF;
+
+    printf("%u steps, %s busy times\n", NUM_STEPS, maximum ? "maximum" : "typical");
+
+    start();
+    SPI0_init(2);
+    SPI0_slaveInit(SPI0_FLASH_SS);
+    SPI0_slaveInit(SPI0_DAC_SS);
+    SPI0_profile(SPI0_FLASH_SS, SPI0_FLASH_CLOCK, SPI0_FLASH_MODE);
+    SPI0_profile(SPI0_DAC_SS, SPI0_DAC_CLOCK, SPI0_DAC_MODE);
+    mem_init();
+    printf("mem_init        %10.1f us\n", stop());
+
+    start();
+    cal_init();
+    song_init();
+    rec_init();
+    printf("cal/song/rec    %10.1f us\n", stop());
+
+    start();
+    restoreContext();
+    printf("restoreContext  %10.1f us (boot)\n", stop());
+    w25q_printStats();
+
+    w25q_resetStats();
+    for (unsigned i = 0; i < saves; i++) {
+        randomize();
+
+        start();
+        saveContext();
+        t = stop();
+        tSave += t;
+        tSaveMax = (t > tSaveMax) ? t : tSaveMax;
+
+        st = status;
+        memcpy(pat, patterns, sizeof(pat));
+        memset(&status, 0, sizeof(status));
+        memset(patterns, 0, sizeof(patterns));
+
+        start();
+        restoreContext();
+        t = stop();
+        tLoad += t;
+        tLoadMax = (t > tLoadMax) ? t : tLoadMax;
+
+        if (!same(&st, pat)) {
+            printf("round trip %u: restored context differs\n", i);
+            bad++;
+        }
+        if (!live()) {
+            printf("round trip %u: published pattern differs\n", i);
+            bad++;
+        }
+    }
+
+    if (saves) {
+        printf("saveContext     %10.1f us avg %10.1f us max\n", tSave / saves, tSaveMax);
+        printf("restoreContext  %10.1f us avg %10.1f us max\n", tLoad / saves, tLoadMax);
+        w25q_printStats();
+    }
+
+    bad += torn();
+
+    // let the last program finish before the image is closed
+    mem_waitBusy();
+
+    w25q_close();
+
+    return bad ? 1 : 0;
+
+}
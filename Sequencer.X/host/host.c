@@ -0,0 +1,180 @@
+/*
+ * File:   host.c
+ * Author: N Mark
+ *
+ * Host side of the firmware's hardware: peripheral registers as plain
+ * memory, the emulated clock behind bench_now() and the delays, and
+ * USART3 on stdout.
+ */
+
+#include <stdio.h>
+#include "sequencer_utils.h"
+#include "host.h"
+
+PORT_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF;
+SPI_t SPI0;
+ADC_t ADC0;
+AC_t AC0;
+VREF_t VREF;
+USART_t USART0, USART1, USART2, USART3;
+RTC_t RTC;
+CLKCTRL_t CLKCTRL;
+PORTMUX_t PORTMUX;
+TCA_t TCA0;
+TCB_t TCB0, TCB1, TCB2, TCB3;
+EVSYS_t EVSYS;
+CCL_t CCL;
+SLPCTRL_t SLPCTRL;
+CPUINT_t CPUINT;
+register8_t SREG;
+register16_t SP = RAMEND;
+
+/*
+ * local variables
+ */
+static uint64_t hostNs;     // emulated time since start
+
+/* @NAME: host_now
+ *
+ * @DESCRIPTION: Returns the emulated time in ns
+ *
+ */
+uint64_t host_now(void) {
+    return hostNs;
+}
+
+/* @NAME: host_advance
+ *
+ * @DESCRIPTION: Moves the emulated clock on by ns
+ *
+ */
+void host_advance(uint64_t ns) {
+    hostNs += ns;
+}
+
+void _delay_us(double us) {
+    hostNs += (uint64_t)(us * 1000);
+}
+
+void _delay_ms(double ms) {
+    hostNs += (uint64_t)(ms * 1000000);
+}
+
+/* @NAME: bench_init
+ *
+ * @DESCRIPTION: Nothing to start; bench_now() follows the host clock
+ *
+ */
+void bench_init(void) {
+    return;
+}
+
+/* @NAME: bench_now
+ *
+ * @DESCRIPTION: Returns the host clock in CLK_PER ticks, wrapping like TCB3
+ *
+ */
+uint16_t bench_now(void) {
+    return hostNs * F_CPU / 1000000000ULL;
+}
+
+/*
+ * terminalPrint.h on stdout, same formats as on the target
+ */
+void USART3_init() {
+    return;
+}
+
+void USART3_sendChar(char c) {
+    if (c != '\r') {
+        putchar(c);
+    }
+}
+
+void USART3_sendString(char *str) {
+    while (*str) {
+        USART3_sendChar(*str++);
+    }
+}
+
+void USART3_sendByte(uint8_t byte) {
+    char buff[9] = {0};
+    itoa(byte, buff, 2);
+    USART3_sendString(buff);
+}
+
+void USART3_sendNum(uint8_t num) {
+    char buff[4] = {0};
+    itoa(num, buff, 10);
+    USART3_sendString(buff);
+}
+
+void USART3_sendWord(uint16_t num) {
+    char buff[6] = {0};
+    utoa(num, buff, 10);
+    USART3_sendString(buff);
+}
+
+void USART3_sendHex(uint8_t num) {
+    char buff[3] = {0};
+    itoa(num, buff, 16);
+    USART3_sendString("0x");
+    USART3_sendString(buff);
+}
+
+uint8_t USART3_read() {
+    int c = getchar();
+    return (c == EOF) ? '\n' : c;
+}
+
+uint16_t USART3_readNum() {
+    uint16_t num = 0;
+    char c = USART3_read();
+
+    while (c != '\r' && c != '\n') {
+        if (c >= '0' && c <= '9') {
+            num = num * 10 + (c - '0');
+        }
+        c = USART3_read();
+    }
+
+    return num;
+}
+
+/*
+ * avr-libc number conversions
+ */
+char *ultoa(unsigned long val, char *buf, int radix) {
+
+    char tmp[33];
+    int n = 0, i = 0;
+
+    do {
+        tmp[n++] = "0123456789abcdefghijklmnopqrstuvwxyz"[val % radix];
+        val /= radix;
+    } while (val);
+
+    while (n) {
+        buf[i++] = tmp[--n];
+    }
+    buf[i] = '\0';
+
+    return buf;
+
+}
+
+char *utoa(unsigned int val, char *buf, int radix) {
+    return ultoa(val, buf, radix);
+}
+
+char *itoa(int val, char *buf, int radix) {
+
+    if (val < 0 && radix == 10) {
+        buf[0] = '-';
+        ultoa(-(long)val, buf + 1, radix);
+        return buf;
+    }
+
+    return ultoa((unsigned int)val, buf, radix);
+
+}
@@ -0,0 +1,40 @@
+/*
+ * File:   host.h
+ * Author: N Mark
+ *
+ * Host build glue: the emulated clock, the hooks of the host stand-ins
+ * and the avr-libc extensions the firmware uses. Force-included into every host compile (see Makefile).
+ *
+ * The clock only moves when the firmware waits: every SPI byte costs its
+ * shift time at the selected slave's SPI0 profile and every _delay_us/_delay_ms its
+ * argument. CPU time between bytes is not counted, so host timings are a
+ * lower bound of the on-target ones.
+ *
+ */
+
+#ifndef HOST_H
+#define	HOST_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* CLK_PER cycles -> ns; SPI bytes cost SPI0_byteClocks of their slave */
+#define HOST_CLOCKS_NS(n)   ((n) * 1000000000ULL / 3333333)
+
+uint64_t host_now(void);
+void host_advance(uint64_t);
+
+/* host_adc.c */
+void host_adcFeed(const uint16_t *, uint32_t);
+uint32_t host_adcMissed(void);
+
+/* host_spi.c */
+void host_dacLog(FILE *);
+uint32_t host_dacFrames(void);
+void host_dacFrame(uint8_t, uint8_t);
+
+char *itoa(int, char *, int);
+char *utoa(unsigned int, char *, int);
+char *ultoa(unsigned long, char *, int);
+
+#endif	/* HOST_H */
@@ -0,0 +1,97 @@
+/*
+ * File:   host_adc.c
+ * Author: N Mark
+ *
+ * adc.h on the host. There is no background scan; the CV samples the
+ * firmware reads (ADC0_latest/ADC0_next) are taken in order from a feed,
+ * the TRACE_ADC records of a trace on replay.
+ *
+ * @NOTE: Reads past the end of the feed repeat its last sample (mid-scale
+ *        without a feed) and are counted by host_adcMissed()
+ */
+
+#include <stdbool.h>
+#include "adc.h"
+#include "host.h"
+
+/*
+ * local variables
+ */
+static const uint16_t *adcFeed;     // samples in the order they are read
+static uint32_t adcLen;
+static uint32_t adcPos;             // next sample to read
+static uint32_t adcMissed;          // reads past the end
+static uint16_t adcLast = 1 << (ADC_RESULT_BITS - 1);
+
+/* @NAME: host_adcFeed
+ *
+ * @DESCRIPTION: Sets the samples returned by the next reads
+ *
+ */
+void host_adcFeed(const uint16_t *samples, uint32_t n) {
+
+    adcFeed = samples;
+    adcLen = n;
+    adcPos = 0;
+    adcMissed = 0;
+
+}
+
+/* @NAME: host_adcMissed
+ *
+ * @DESCRIPTION: Returns the reads that found the feed empty
+ *
+ */
+uint32_t host_adcMissed(void) {
+    return adcMissed;
+}
+
+/* @NAME: host_adcRead
+ *
+ * @DESCRIPTION: Returns the next sample of the feed
+ *
+ */
+static uint16_t host_adcRead(void) {
+
+    if (adcPos < adcLen) {
+        adcLast = adcFeed[adcPos++];
+    } else {
+        adcMissed++;
+    }
+
+    return adcLast;
+
+}
+
+void ADC0scan_init(void) {
+    return;
+}
+
+void ADC0_scanNext(void) {
+    return;
+}
+
+uint16_t ADC0_latest(void) {
+    return host_adcRead();
+}
+
+uint16_t ADC0_next(void) {
+    return host_adcRead();
+}
+
+uint16_t ADC0_value(uint8_t slot) {
+    return (slot == ADC_CH_CV) ? adcLast : 0;
+}
+
+void ADC0_setRate(uint8_t ch, uint8_t rate) {
+    (void)ch;
+    (void)rate;
+}
+
+void ADC0_scanPause(void) {
+    return;
+}
+
+void ADC0_scanResume(void) {
+    return;
+}
@@ -0,0 +1,35 @@
+/*
+ * File:   host_dac.c
+ * Author: N Mark
+ *
+ * dac.h on the host. A DAC_USART frame is counted and logged with the
+ * SPI0 ones and is complete when dac_write returns, so the transmit
+ * complete ISR is never needed; each frame advances the host clock by its
+ * two bytes at DAC_SCK_HZ.
+ */
+
+#include <stdbool.h>
+#include "sequencer_utils.h"
+#include "host.h"
+
+void dac_init(void) {
+    return;
+}
+
+void dac_write(uint8_t high, uint8_t low) {
+#ifdef DAC_USART
+    host_advance(HOST_CLOCKS_NS(16 * F_CPU / DAC_SCK_HZ));
+    host_dacFrame(high, low);
+#else
+    (void)high;
+    (void)low;
+#endif
+}
+
+void dac_txc(void) {
+    return;
+}
+
+bool dac_busy(void) {
+    return false;
+}
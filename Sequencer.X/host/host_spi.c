@@ -0,0 +1,182 @@
+/*
+ * File:   host_spi.c
+ * Author: N Mark
+ *
+ * spi.h on the host: the flash chip select and bytes go to the W25Q32JV
+ * emulator, DAC frames are counted and optionally logged. Every byte
+ * advances the host clock by its shift time with the profile of the slave
+ * selected last.
+ *
+ * @NOTE: Nothing preempts a stream on the host (no interrupts), but the
+ *        stream bookkeeping is the firmware's so the driver paths match
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "spi.h"
+#include "host.h"
+#include "w25q_emu.h"
+
+/*
+ * local variables
+ */
+static uint8_t spi0_selected;       // slave with its chip select low, 0 if none
+static uint8_t spi0_stream;         // slave of the open transaction, 0 if none
+static bool spi0_preempted;         // a DAC frame broke into the transaction
+static uint32_t spi0_dacFrames;     // frames sent to the DAC
+static FILE *spi0_dacLog;           // every frame with its time, if set
+static uint8_t spi0_profileAddr[SPI0_PROFILES];
+static uint8_t spi0_profileClock[SPI0_PROFILES];
+static uint64_t spi0_byteNs = HOST_CLOCKS_NS(64);  // SPI0_init: DIV16, CLK2X
+
+/* @NAME: host_dacLog
+ *
+ * @DESCRIPTION: Prints every following DAC frame to f (NULL stops)
+ *
+ */
+void host_dacLog(FILE *f)
+{
+    spi0_dacLog = f;
+}
+
+/* @NAME: host_dacFrames
+ *
+ * @DESCRIPTION: Returns the frames sent to the DAC so far
+ *
+ */
+uint32_t host_dacFrames(void)
+{
+    return spi0_dacFrames;
+}
+
+/* @NAME: host_dacFrame
+ *
+ * @DESCRIPTION: Counts and logs a frame the DAC has received, on either
+ *               bus
+ *
+ */
+void host_dacFrame(uint8_t high, uint8_t low)
+{
+    spi0_dacFrames++;
+
+    if (spi0_dacLog) {
+        fprintf(spi0_dacLog, "%12.1f dac %02x%02x\n", host_now() / 1000.0, high, low);
+    }
+}
+
+void SPI0_init(uint8_t muxSel)
+{
+    (void)muxSel;
+}
+
+void SPI0_profile(uint8_t addr, uint8_t clock, uint8_t mode)
+{
+    (void)mode;
+
+    for (int i = 0; i < SPI0_PROFILES; i++) {
+        if (spi0_profileAddr[i] == addr || spi0_profileAddr[i] == 0) {
+            spi0_profileAddr[i] = addr;
+            spi0_profileClock[i] = clock & (SPI_PRESC_gm | SPI_CLK2X_bm);
+            return;
+        }
+    }
+}
+
+uint16_t SPI0_byteClocks(uint8_t addr)
+{
+    static const uint8_t div[4] = {4, 16, 64, 128};
+    uint8_t clock = SPI_PRESC_DIV16_gc | SPI_CLK2X_bm;
+    uint16_t clocks;
+
+    for (int i = 0; i < SPI0_PROFILES; i++) {
+        if (spi0_profileAddr[i] == addr) {
+            clock = spi0_profileClock[i];
+            break;
+        }
+    }
+
+    clocks = 8 * div[(clock & SPI_PRESC_gm) >> SPI_PRESC_gp];
+    if (clock & SPI_CLK2X_bm) {
+        clocks >>= 1;
+    }
+
+    return clocks;
+}
+
+uint8_t SPI0_transmit(uint8_t data)
+{
+    host_advance(spi0_byteNs);
+
+    if (spi0_selected == SPI0_FLASH_SS) {
+        return w25q_transfer(data);
+    }
+
+    return 0xFF;
+}
+
+void SPI0_select(uint8_t addr, uint8_t sel)
+{
+    if (addr == SPI0_FLASH_SS) {
+        w25q_select(sel);
+    }
+
+    if (sel) {
+        spi0_byteNs = HOST_CLOCKS_NS(SPI0_byteClocks(addr));
+        spi0_selected = addr;
+    } else if (spi0_selected == addr) {
+        spi0_selected = 0;
+    }
+}
+
+void SPI0_slaveInit(uint8_t addr)
+{
+    SPI0_select(addr, 0);
+}
+
+void SPI0_streamOpen(uint8_t addr)
+{
+    spi0_preempted = false;
+    spi0_stream = addr;
+    SPI0_select(addr, 1);
+}
+
+bool SPI0_streamByte(uint8_t data, uint8_t *rx)
+{
+    if (spi0_preempted) {
+        return false;
+    }
+    *rx = SPI0_transmit(data);
+
+    return true;
+}
+
+bool SPI0_streamPreempted(void)
+{
+    return spi0_preempted;
+}
+
+bool SPI0_streamClose(void)
+{
+    bool intact;
+
+    SPI0_select(spi0_stream, 0);
+    intact = !spi0_preempted;
+    spi0_stream = 0;
+    spi0_preempted = false;
+
+    return intact;
+}
+
+void SPI0_dacWrite(uint8_t high, uint8_t low)
+{
+    if (spi0_stream && !spi0_preempted) {
+        SPI0_select(spi0_stream, 0);
+        spi0_preempted = true;
+    }
+
+    SPI0_select(SPI0_DAC_SS, 1);
+    SPI0_transmit(high);
+    SPI0_transmit(low);
+    SPI0_select(SPI0_DAC_SS, 0);
+    host_dacFrame(high, low);
+}
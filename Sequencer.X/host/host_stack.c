@@ -0,0 +1,24 @@
+/*
+ * File:   host_stack.c
+ * Author: N Mark
+ *
+ * stack.h on the host. There is no painted AVR stack to measure: SP is a
+ * plain register that stays at RAMEND, so every depth STACK_SAMPLE takes
+ * is 0 and nothing is reported.
+ */
+
+#include "sequencer_utils.h"
+
+volatile uint16_t stackIsrDepth[STACK_ISRS];
+
+uint16_t stack_highWater(void) {
+    return 0;
+}
+
+uint16_t stack_size(void) {
+    return RAMEND - RAMSTART + 1;
+}
+
+void stack_report(void) {
+    return;
+}
@@ -0,0 +1,396 @@
+/*
+ * File:   replay.c
+ * Author: N Mark
+ *
+ * Replays a TRACE_CAPTURE trace (see trace.h) through the host build of
+ * the firmware: boots from a flash image as main() does, then at each
+ * record's time sets the pins (or MIDI byte) it carries and runs the
+ * firmware's own ISR (main.c, built with main renamed), with the main loop
+ * services and the TCB2 sample tick run in between. The CV samples of the
+ * trace are fed to the ADC reads in order, and the settings traced by the
+ * pot services are applied as the pots made them.
+ *
+ * The replay has to be built with the unit's feature flags (DEFS, see the
+ * Makefile): a CLOCK_DIVIDER trace's gates are TCA0 overflows, MIDI bytes
+ * only step a MIDI_INPUT build.
+ *
+ * Prints a transcript: each gate and pin record, each DAC frame and the
+ * firmware's USART3 text, stamped with the host time, followed by the
+ * gate (or MIDI clock) to DAC latency. Transcripts of two firmware versions replaying the
+ * same trace can be diffed.
+ *
+ * usage: replay [-d] [-i image] capture
+ *        -d  decode the records only
+ *        -i  flash image to boot from (default replay.img); use a copy of
+ *            the unit's context for an exact replay
+ *
+ * capture is the raw USART3 byte stream; text between the frames is
+ * skipped. Host time only counts SPI and delays (see host.h), so the
+ * latencies compare firmware versions rather than predict the target.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "sequencer_utils.h"
+#include "host.h"
+#include "w25q_emu.h"
+
+#define TICK_NS     (1000000000ULL / REC_SAMPLE_RATE)
+
+typedef struct record {
+
+    uint64_t ns;        // since the first record
+    uint8_t type;
+    uint8_t data;
+
+} record_t;
+
+/* the firmware's ISRs, from main.c */
+void AC0_AC_vect(void);
+void TCA0_OVF_vect(void);
+void USART2_RXC_vect(void);
+void TCB2_INT_vect(void);
+void PORTA_PORT_vect(void);
+void PORTB_PORT_vect(void);
+void PORTC_PORT_vect(void);
+void PORTD_PORT_vect(void);
+void PORTF_PORT_vect(void);
+
+/*
+ * local variables
+ */
+static record_t *recs;
+static uint32_t nRecs;
+static uint16_t *samples;
+static uint32_t nSamples;
+static bool tickOn;             // TCB2 seen enabled
+static uint64_t nextTick;
+
+/* @NAME: load
+ *
+ * @DESCRIPTION: Reads the frames of a capture into recs[] with absolute
+ *               times, and the CV samples into samples[]
+ *
+ */
+static bool load(const char *path) {
+
+    FILE *f = fopen(path, "rb");
+    uint8_t b[6];
+    uint64_t ticks = 0;
+    long len;
+    uint8_t *buf;
+
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    rewind(f);
+    buf = malloc(len);
+    if (fread(buf, 1, len, f) != (size_t)len) {
+        perror(path);
+        return false;
+    }
+    fclose(f);
+
+    recs = malloc(sizeof(record_t) * (len / 6 + 1));
+    samples = malloc(sizeof(uint16_t) * (len / 6 + 1));
+
+    for (long i = 0; i + 6 <= len; i++) {
+        memcpy(b, buf + i, 6);
+        if (b[0] != TRACE_SYNC || (b[1] ^ b[2] ^ b[3] ^ b[4]) != b[5]) {
+            continue;
+        }
+        i += 5;
+
+        if (b[1] == TRACE_GAP) {
+            ticks += (uint64_t)(b[3] | b[4] << 8) << 16;
+            continue;
+        }
+        ticks += b[3] | b[4] << 8;
+
+        if (b[1] & TRACE_ADC) {
+            samples[nSamples++] = (b[1] & 0x7F) << 8 | b[2];
+            continue;
+        }
+        recs[nRecs].ns = ticks * 1000000000ULL / F_CPU;
+        recs[nRecs].type = b[1];
+        recs[nRecs].data = b[2];
+        nRecs++;
+    }
+
+    free(buf);
+
+    return true;
+
+}
+
+/* @NAME: name
+ *
+ * @DESCRIPTION: Returns the transcript name of a record type
+ *
+ */
+static const char *name(uint8_t type) {
+
+    static const char *names[] = {
+        "gap", "lost", "start", "gate", "porta", "portb", "portc", "portd", "portf",
+        "midi", "gpot", "dpot"
+    };
+
+    return (type <= TRACE_DIV_POT) ? names[type] : "?";
+
+}
+
+/* @NAME: service
+ *
+ * @DESCRIPTION: One pass of the main loop, without the sleep
+ *
+ */
+static void service(void) {
+
+    event_t evt;
+
+    mem_wakeService();
+    while (evt_get(&evt)) {
+        handleEvent(&evt);
+    }
+    if (evt_dropped()) {
+        USART3_sendString("events dropped\n\r");
+    }
+    song_service();
+    rec_service();
+    play_service();
+    mem_eraseService();
+    midi_service();
+    gate_service();
+    clock_service();
+
+}
+
+/* @NAME: runUntil
+ *
+ * @DESCRIPTION: Runs the main loop and the TCB2 tick up to host time t
+ *
+ */
+static void runUntil(uint64_t t) {
+
+    uint64_t next;
+
+    for (;;) {
+        service();
+
+        if (TCB2.CTRLA & TCB_ENABLE_bm) {
+            if (!tickOn) {
+                tickOn = true;
+                nextTick = host_now() + TICK_NS;
+            }
+        } else {
+            tickOn = false;
+        }
+
+        // idle until the next tick or the record
+        next = (tickOn && nextTick < t) ? nextTick : t;
+        if (host_now() < next) {
+            host_advance(next - host_now());
+        }
+
+        if (tickOn && host_now() >= nextTick) {
+            TCB2_INT_vect();
+            nextTick += TICK_NS;
+            continue;
+        }
+        if (host_now() >= t) {
+            return;
+        }
+    }
+
+}
+
+/* @NAME: boot
+ *
+ * @DESCRIPTION: The init sequence of main(), without the factory reset
+ *
+ */
+static void boot(void) {
+
+    SPI0_init(2);
+    SPI0_slaveInit(SPI0_FLASH_SS);
+    SPI0_profile(SPI0_FLASH_SS, SPI0_FLASH_CLOCK, SPI0_FLASH_MODE);
+#ifdef DAC_USART
+    dac_init();
+#else
+    SPI0_slaveInit(SPI0_DAC_SS);
+    SPI0_profile(SPI0_DAC_SS, SPI0_DAC_CLOCK, SPI0_DAC_MODE);
+#endif
+    io_init();
+    USART3_init();
+    ADC0scan_init();
+    AC0redge_init();
+    mem_init();
+    cal_init();
+    song_init();
+    rec_init();
+    bench_init();
+    pwr_init();
+    trace_init();
+    midi_init();
+    gate_init();
+    clock_init();
+    restoreContext();
+    sei();
+
+}
+
+int main(int argc, char **argv) {
+
+    const char *image = "replay.img";
+    bool decode = false;
+    uint64_t base, t, lat, latMax = 0, latSum = 0;
+    uint32_t gates = 0, late = 0, frames;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "di:")) != -1) {
+        switch (opt) {
+            case 'd':
+                decode = true;
+                break;
+            case 'i':
+                image = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-d] [-i image] capture\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1 || !load(argv[optind])) {
+        fprintf(stderr, "usage: %s [-d] [-i image] capture\n", argv[0]);
+        return 2;
+    }
+
+    printf("%u records, %u CV samples\n", nRecs, nSamples);
+
+    if (decode) {
+        for (uint32_t i = 0; i < nRecs; i++) {
+            printf("%12.1f %-5s %02x\n", recs[i].ns / 1000.0, name(recs[i].type), recs[i].data);
+        }
+        return 0;
+    }
+
+    if (!w25q_open(image, W25Q_SIZE, false)) {
+        return 1;
+    }
+
+    // no button held at boot, gate low
+    PORTA.IN = PORTB.IN = PORTC.IN = PORTD.IN = PORTF.IN = 0xFF;
+    boot();
+
+    host_adcFeed(samples, nSamples);
+    host_dacLog(stdout);
+    base = host_now();
+
+    for (uint32_t i = 0; i < nRecs; i++) {
+        t = base + recs[i].ns;
+        runUntil(t);
+        if (host_now() > t + TICK_NS) {
+            late++;
+        }
+
+        printf("%12.1f %-5s %02x\n", host_now() / 1000.0, name(recs[i].type), recs[i].data);
+
+        switch (recs[i].type) {
+            case TRACE_START:
+                if (recs[i].data != NUM_STEPS) {
+                    printf("trace is from a %u step build\n", recs[i].data);
+                }
+                break;
+            case TRACE_LOST:
+                printf("%u records lost, the replay diverges from here\n", recs[i].data);
+                break;
+            case TRACE_GATE:
+                if (!recs[i].data) {
+                    AC0.STATUS &= ~AC_STATE_bm;
+                    break;
+                }
+                AC0.STATUS |= AC_STATE_bm;
+                t = host_now();
+                frames = host_dacFrames();
+#ifdef CLOCK_DIVIDER
+                TCA0_OVF_vect();
+#else
+                AC0_AC_vect();
+#endif
+                if (host_dacFrames() != frames) {
+                    lat = host_now() - t;
+                    latSum += lat;
+                    latMax = (lat > latMax) ? lat : latMax;
+                    gates++;
+                }
+                break;
+            case TRACE_MIDI:
+#ifdef MIDI_INPUT
+                USART2.RXDATAL = recs[i].data;
+                t = host_now();
+                frames = host_dacFrames();
+                USART2_RXC_vect();
+                if (host_dacFrames() != frames) {
+                    lat = host_now() - t;
+                    latSum += lat;
+                    latMax = (lat > latMax) ? lat : latMax;
+                    gates++;
+                }
+#else
+                printf("trace is from a MIDI_INPUT build\n");
+#endif
+                break;
+            case TRACE_GATE_POT:
+                setStepGate(recs[i].data);
+                break;
+            case TRACE_DIV_POT:
+                setClockDiv(recs[i].data);
+                break;
+            case TRACE_PORTA:
+                PORTA.IN = recs[i].data;
+                PORTA_PORT_vect();
+                break;
+            case TRACE_PORTB:
+                PORTB.IN = recs[i].data;
+                PORTB_PORT_vect();
+                break;
+            case TRACE_PORTC:
+                PORTC.IN = recs[i].data;
+                PORTC_PORT_vect();
+                break;
+            case TRACE_PORTD:
+                PORTD.IN = recs[i].data;
+                PORTD_PORT_vect();
+                break;
+            case TRACE_PORTF:
+                PORTF.IN = recs[i].data;
+                PORTF_PORT_vect();
+                break;
+        }
+    }
+
+    // let recordings and saves finish
+    runUntil(host_now() + 1000000000ULL);
+    mem_waitBusy();
+    host_dacLog(NULL);
+
+    if (gates) {
+        printf("gate to dac %.1f us avg %.1f us max over %u gates\n",
+                latSum / 1000.0 / gates, latMax / 1000.0, gates);
+    }
+    if (late) {
+        printf("%u records replayed late\n", late);
+    }
+    if (host_adcMissed()) {
+        printf("%u CV reads past the trace\n", host_adcMissed());
+    }
+
+    w25q_close();
+
+    return 0;
+
+}
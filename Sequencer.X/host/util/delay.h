@@ -0,0 +1,16 @@
+/*
+ * File:   delay.h
+ * Author: N Mark
+ *
+ * Host stand-in for <util/delay.h>. Delays advance the emulated clock
+ * (host.c) instead of spinning.
+ *
+ */
+
+#ifndef HOST_UTIL_DELAY_H
+#define	HOST_UTIL_DELAY_H
+
+void _delay_us(double);
+void _delay_ms(double);
+
+#endif	/* HOST_UTIL_DELAY_H */
@@ -0,0 +1,620 @@
+/*
+ * File:   w25q_emu.c
+ * Author: N Mark
+ *
+ * W25Q32JV emulator; see w25q_emu.h. Timing from the W25Q32JV datasheet
+ * (AC characteristics), typical and maximum.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "host.h"
+#include "w25q_emu.h"
+
+#define US                  1000ULL
+#define MS                  1000000ULL
+
+#define SR1_BUSY            0x01
+#define SR1_WEL             0x02
+#define SR1_WRITABLE        0xFC    // BP0-2, TB, SEC, SRP
+#define SR2_SUS             0x80
+#define SR2_WRITABLE        0x43    // SRL, QE, CMP; LB1-3 are OTP, not kept
+#define SR3_WRITABLE        0x64    // WPS, DRV
+
+#define T_SUS               (20 * US)
+#define T_DP                (3 * US)
+#define T_RES1              (3 * US)
+
+/* busy operations */
+#define OP_NONE             0
+#define OP_PROGRAM          1
+#define OP_ERASE            2
+#define OP_STATUS           3
+#define OP_SUSPEND          4       // busy until tSUS after 0x75
+
+/* typical and maximum busy times: tPP, tSE, tBE1, tBE2, tCE, tW */
+static const uint64_t opTime[2][6] = {
+    {400 * US, 45 * MS, 120 * MS, 150 * MS, 10000 * MS, 10 * MS},
+    {3 * MS, 400 * MS, 1600 * MS, 2000 * MS, 50000 * MS, 15 * MS},
+};
+#define T_PP                0
+#define T_SE                1
+#define T_BE1               2
+#define T_BE2               3
+#define T_CE                4
+#define T_W                 5
+
+/*
+ * local variables
+ */
+static int fd = -1;
+static uint8_t *image;              // mapped image file
+static uint32_t size;
+static uint8_t timing;              // 0 typical, 1 maximum
+static uint8_t sfdp[0x100];         // SFDP header and basic parameter table
+static w25q_stats_t stats;
+
+static uint8_t sr[3];               // status registers 1-3
+static bool addr4;                  // 4-byte address mode
+static bool resetEnabled;           // 0x66 seen, 0x99 resets
+static uint8_t busyOp = OP_NONE;
+static uint64_t busyUntil;
+static uint8_t suspendedOp = OP_NONE;
+static uint64_t suspendedLeft;      // busy time left of the suspended operation
+static bool down;                   // in power-down
+static uint64_t readyAt;            // end of tDP or tRES1
+
+static bool selected;
+static bool ignored;                // instruction dropped on its first byte
+static uint8_t cmd;
+static uint32_t pos;                // bytes since chip select fell
+static uint32_t addr;
+static uint8_t page[W25Q_PAGE_SIZE];    // page program buffer
+static bool pageSet[W25Q_PAGE_SIZE];
+static uint8_t srIn[3];             // status register write buffer
+static uint8_t srInSet;             // bit per register written
+
+/* @NAME: addrBytes
+ *
+ * @DESCRIPTION: Returns the address length of the current mode
+ *
+ */
+static uint8_t addrBytes(void) {
+    return addr4 ? 4 : 3;
+}
+
+/* @NAME: busyUpdate
+ *
+ * @DESCRIPTION: Ends the busy operation once its time is over
+ *
+ */
+static void busyUpdate(void) {
+
+    if (busyOp == OP_NONE || host_now() < busyUntil) {
+        return;
+    }
+
+    sr[0] &= ~SR1_BUSY;
+    if (busyOp != OP_SUSPEND) {
+        sr[0] &= ~SR1_WEL;
+    }
+    busyOp = OP_NONE;
+
+}
+
+/* @NAME: busyStart
+ *
+ * @DESCRIPTION: Sets BUSY for one of the opTime operations
+ *
+ */
+static void busyStart(uint8_t op, uint8_t t) {
+
+    uint64_t ns = opTime[timing][t];
+
+    busyOp = op;
+    busyUntil = host_now() + ns;
+    sr[0] |= SR1_BUSY;
+    stats.busyNs += ns;
+
+}
+
+/* @NAME: sfdpInit
+ *
+ * @DESCRIPTION: Builds the SFDP header and a JESD216 basic flash parameter
+ *               table (11 dwords) for the image size
+ *
+ */
+static void sfdpInit(void) {
+
+    uint32_t bfpt[11] = {
+        0xFFF920E5,     // 4KB erase 0x20, 3-byte addresses
+        size * 8 - 1,   // density in bits - 1
+        0x6B08EB44, 0xBB423B08, 0xFFFFFFFE, 0xFF00FFFF, 0xEB40FFFF,
+        0x520F200C,     // erase types 1, 2: 4KB 0x20, 32KB 0x52
+        0x0000D810,     // erase type 3: 64KB 0xD8
+        0x00000000,
+        0x00000080,     // 256 byte pages
+    };
+
+    if (size > 0x1000000UL) {
+        bfpt[0] = (bfpt[0] & ~0x00060000UL) | 0x00020000UL; // 3 or 4 bytes
+    }
+
+    memset(sfdp, 0xFF, sizeof(sfdp));
+    memcpy(sfdp, "SFDP", 4);
+    sfdp[4] = 0x05;                 // JESD216 minor, major revision
+    sfdp[5] = 0x01;
+    sfdp[6] = 0x00;                 // one parameter header
+    sfdp[8] = 0x00;                 // basic table, revision 1.0, 11 dwords
+    sfdp[9] = 0x00;
+    sfdp[10] = 0x01;
+    sfdp[11] = 11;
+    sfdp[12] = 0x80;                // at 0x80
+    sfdp[13] = 0x00;
+    sfdp[14] = 0x00;
+
+    for (uint8_t i = 0; i < 11; i++) {
+        for (uint8_t b = 0; b < 4; b++) {
+            sfdp[0x80 + 4 * i + b] = bfpt[i] >> (8 * b);
+        }
+    }
+
+}
+
+/* @NAME: w25q_open
+ *
+ * @DESCRIPTION: Maps the image file as the flash array, creating or
+ *               growing it erased (0xFF) as needed
+ *
+ * @PARAM:
+ *          path:    image file
+ *          bytes:   capacity, a power of two from 1MB (W25Q_SIZE for the
+ *                   W25Q32JV)
+ *          maximum: busy times at their datasheet maximum, not typical
+ *
+ */
+bool w25q_open(const char *path, uint32_t bytes, bool maximum) {
+
+    struct stat st;
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        return false;
+    }
+
+    if ((uint64_t)st.st_size < bytes && ftruncate(fd, bytes) < 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+
+    image = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (image == MAP_FAILED) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+
+    if ((uint64_t)st.st_size < bytes) {
+        memset(image + st.st_size, 0xFF, bytes - st.st_size);
+    }
+
+    size = bytes;
+    timing = maximum ? 1 : 0;
+    sfdpInit();
+    w25q_resetStats();
+
+    return true;
+
+}
+
+/* @NAME: w25q_close
+ *
+ * @DESCRIPTION: Writes the image back and unmaps it
+ *
+ */
+void w25q_close(void) {
+
+    if (fd < 0) {
+        return;
+    }
+
+    msync(image, size, MS_SYNC);
+    munmap(image, size);
+    close(fd);
+    fd = -1;
+
+}
+
+/* @NAME: allowed
+ *
+ * @DESCRIPTION: Returns true if an instruction is accepted in the current
+ *               state; counts the ones that are not
+ *
+ */
+static bool allowed(uint8_t c) {
+
+    bool erase = (c == 0x20 || c == 0x52 || c == 0xD8 || c == 0xC7 || c == 0x60);
+
+    if (down || host_now() < readyAt) {
+        if (c != 0xAB || (!down && host_now() < readyAt)) {
+            stats.whileDown++;
+            return false;
+        }
+        return true;
+    }
+
+    busyUpdate();
+
+    if (busyOp != OP_NONE) {
+        // status reads always; suspend of a program or erase
+        if (c == 0x05 || c == 0x35 || c == 0x15
+                || (c == 0x75 && (busyOp == OP_PROGRAM || busyOp == OP_ERASE))) {
+            return true;
+        }
+        stats.whileBusy++;
+        return false;
+    }
+
+    // while suspended: no erase, no status write, no program into a
+    // suspended program
+    if (sr[1] & SR2_SUS) {
+        if (erase || c == 0x01 || c == 0x31 || c == 0x11
+                || (c == 0x02 && suspendedOp == OP_PROGRAM)) {
+            stats.whileBusy++;
+            return false;
+        }
+    }
+
+    return true;
+
+}
+
+/* @NAME: w25q_select
+ *
+ * @DESCRIPTION: Chip select; true pulls it low. The instruction clocked in
+ *               is executed when it goes high
+ *
+ */
+void w25q_select(bool sel) {
+
+    if (sel) {
+        selected = true;
+        ignored = false;
+        pos = 0;
+        addr = 0;
+        return;
+    }
+
+    if (!selected) {
+        return;
+    }
+    selected = false;
+
+    if (ignored || pos == 0) {
+        return;
+    }
+
+    if (cmd != 0x66 && cmd != 0x99) {
+        resetEnabled = false;
+    }
+
+    switch (cmd) {
+        case 0x06:
+            sr[0] |= SR1_WEL;
+            break;
+        case 0x04:
+            sr[0] &= ~SR1_WEL;
+            break;
+
+        case 0x01:
+        case 0x31:
+        case 0x11:
+            if (pos < 2) {
+                break;
+            }
+            if (!(sr[0] & SR1_WEL)) {
+                stats.noWel++;
+                break;
+            }
+            if (srInSet & 0x01) {
+                sr[0] = (sr[0] & ~SR1_WRITABLE) | (srIn[0] & SR1_WRITABLE);
+            }
+            if (srInSet & 0x02) {
+                sr[1] = (sr[1] & ~SR2_WRITABLE) | (srIn[1] & SR2_WRITABLE);
+            }
+            if (srInSet & 0x04) {
+                sr[2] = (sr[2] & ~SR3_WRITABLE) | (srIn[2] & SR3_WRITABLE);
+            }
+            busyStart(OP_STATUS, T_W);
+            break;
+
+        case 0x02:
+            if (pos <= 1u + addrBytes()) {
+                break;
+            }
+            if (!(sr[0] & SR1_WEL)) {
+                stats.noWel++;
+                break;
+            }
+            addr &= (size - 1) & ~(W25Q_PAGE_SIZE - 1);
+            for (uint16_t i = 0; i < W25Q_PAGE_SIZE; i++) {
+                if (!pageSet[i]) {
+                    continue;
+                }
+                if (page[i] & ~image[addr + i]) {
+                    stats.setBits++;
+                }
+                image[addr + i] &= page[i];
+                stats.bytesProgrammed++;
+            }
+            stats.programs++;
+            busyStart(OP_PROGRAM, T_PP);
+            break;
+
+        case 0x20:
+        case 0x52:
+        case 0xD8:
+        case 0xC7:
+        case 0x60: {
+            uint32_t len;
+            uint8_t t, e;
+
+            if (cmd == 0xC7 || cmd == 0x60) {
+                if (pos != 1) {
+                    break;
+                }
+                len = size;
+                t = T_CE;
+                e = 3;
+            } else {
+                if (pos != 1u + addrBytes()) {
+                    break;
+                }
+                len = (cmd == 0x20) ? 0x1000 : (cmd == 0x52) ? 0x8000 : 0x10000;
+                t = (cmd == 0x20) ? T_SE : (cmd == 0x52) ? T_BE1 : T_BE2;
+                e = (cmd == 0x20) ? 0 : (cmd == 0x52) ? 1 : 2;
+            }
+            if (!(sr[0] & SR1_WEL)) {
+                stats.noWel++;
+                break;
+            }
+            addr &= (size - 1) & ~(len - 1);
+            memset(image + addr, 0xFF, len);
+            stats.erases[e]++;
+            busyStart(OP_ERASE, t);
+            break;
+        }
+
+        case 0x75:
+            if (busyOp != OP_PROGRAM && busyOp != OP_ERASE) {
+                break;
+            }
+            suspendedOp = busyOp;
+            suspendedLeft = busyUntil - host_now();
+            sr[1] |= SR2_SUS;
+            busyOp = OP_SUSPEND;
+            busyUntil = host_now() + T_SUS;
+            stats.suspends++;
+            break;
+        case 0x7A:
+            if (!(sr[1] & SR2_SUS)) {
+                break;
+            }
+            sr[1] &= ~SR2_SUS;
+            sr[0] |= SR1_BUSY;
+            busyOp = suspendedOp;
+            busyUntil = host_now() + suspendedLeft;
+            suspendedOp = OP_NONE;
+            break;
+
+        case 0xB9:
+            down = true;
+            readyAt = host_now() + T_DP;
+            break;
+        case 0xAB:
+            if (down) {
+                down = false;
+                readyAt = host_now() + T_RES1;
+            }
+            break;
+
+        case 0xB7:
+        case 0xE9:
+            addr4 = (cmd == 0xB7);
+            break;
+
+        case 0x66:
+            resetEnabled = true;
+            break;
+        case 0x99:
+            if (resetEnabled) {
+                sr[0] &= ~SR1_WEL;
+                sr[1] &= ~SR2_SUS;
+                addr4 = false;
+                busyOp = OP_NONE;
+                suspendedOp = OP_NONE;
+            }
+            resetEnabled = false;
+            break;
+    }
+
+}
+
+/* @NAME: w25q_transfer
+ *
+ * @DESCRIPTION: Shifts one byte in on MOSI and returns the byte on MISO
+ *
+ */
+uint8_t w25q_transfer(uint8_t mosi) {
+
+    uint32_t n;
+    uint8_t a = addrBytes();
+
+    if (!selected) {
+        return 0xFF;
+    }
+
+    n = pos++;
+
+    if (n == 0) {
+        cmd = mosi;
+        if (cmd == 0xB7 || cmd == 0xE9) {
+            if (size <= 0x1000000UL) {
+                stats.unknown++;
+                ignored = true;
+                return 0xFF;
+            }
+        }
+        ignored = !allowed(cmd);
+        if (cmd == 0x02) {
+            memset(pageSet, 0, sizeof(pageSet));
+        }
+        srInSet = 0;
+        return 0xFF;
+    }
+
+    if (ignored) {
+        return 0xFF;
+    }
+
+    switch (cmd) {
+        case 0x05:
+        case 0x35:
+        case 0x15:
+            busyUpdate();
+            return sr[cmd == 0x05 ? 0 : cmd == 0x35 ? 1 : 2];
+
+        case 0x01:
+        case 0x31:
+        case 0x11: {
+            // 0x01 takes status register 2 as an optional second byte
+            uint8_t r = (cmd == 0x01) ? n - 1 : (cmd == 0x31) ? 1 : 2;
+            if (n > 2 || (cmd != 0x01 && n > 1)) {
+                break;
+            }
+            srIn[r] = mosi;
+            srInSet |= 1 << r;
+            break;
+        }
+
+        case 0x9F:
+            if (n == 1) {
+                return 0xEF;
+            }
+            if (n == 2) {
+                return 0x40;
+            }
+            if (n == 3) {
+                return __builtin_ctzl(size);
+            }
+            break;
+
+        case 0xAB:
+            // release, then the device ID after three dummy bytes
+            return (n >= 4) ? __builtin_ctzl(size) - 1 : 0xFF;
+
+        case 0x5A:
+            if (n <= 3) {
+                addr = (addr << 8) | mosi;
+                break;
+            }
+            if (n == 4) {
+                break;
+            }
+            return (addr < sizeof(sfdp)) ? sfdp[addr++] : 0xFF;
+
+        case 0x03:
+        case 0x0B:
+        case 0x02:
+        case 0x20:
+        case 0x52:
+        case 0xD8:
+            if (n <= a) {
+                addr = (addr << 8) | mosi;
+                if (n == a && (cmd == 0x03 || cmd == 0x0B)) {
+                    stats.reads++;
+                }
+                break;
+            }
+            if (cmd == 0x02) {
+                page[(addr + n - a - 1) & (W25Q_PAGE_SIZE - 1)] = mosi;
+                pageSet[(addr + n - a - 1) & (W25Q_PAGE_SIZE - 1)] = true;
+                break;
+            }
+            if (cmd == 0x0B && n == a + 1u) {
+                break;  // dummy clocks
+            }
+            if (cmd == 0x03 || cmd == 0x0B) {
+                stats.bytesRead++;
+                return image[addr++ & (size - 1)];
+            }
+            break;
+
+        default:
+            if (n == 1) {
+                stats.unknown++;
+            }
+            break;
+    }
+
+    return 0xFF;
+
+}
+
+/* @NAME: w25q_stats
+ *
+ * @DESCRIPTION: Returns the counters since w25q_open or w25q_resetStats
+ *
+ */
+const w25q_stats_t *w25q_stats(void) {
+    return &stats;
+}
+
+/* @NAME: w25q_resetStats
+ *
+ * @DESCRIPTION: Clears the counters
+ *
+ */
+void w25q_resetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+/* @NAME: w25q_printStats
+ *
+ * @DESCRIPTION: Prints the counters; the error lines only when non-zero
+ *
+ */
+void w25q_printStats(void) {
+
+    printf("  reads %u (%llu bytes), programs %u (%llu bytes)\n",
+            stats.reads, (unsigned long long)stats.bytesRead,
+            stats.programs, (unsigned long long)stats.bytesProgrammed);
+    printf("  erases 4K %u, 32K %u, 64K %u, chip %u, suspends %u\n",
+            stats.erases[0], stats.erases[1], stats.erases[2],
+            stats.erases[3], stats.suspends);
+    printf("  busy %.3f ms\n", stats.busyNs / 1e6);
+
+    if (stats.setBits) {
+        printf("  ! %u programmed bytes tried to set bits\n", stats.setBits);
+    }
+    if (stats.noWel) {
+        printf("  ! %u program/erase/status writes without WREN\n", stats.noWel);
+    }
+    if (stats.whileBusy) {
+        printf("  ! %u instructions while busy\n", stats.whileBusy);
+    }
+    if (stats.whileDown) {
+        printf("  ! %u instructions while powered down\n", stats.whileDown);
+    }
+    if (stats.unknown) {
+        printf("  %u unsupported instructions ignored\n", stats.unknown);
+    }
+
+}
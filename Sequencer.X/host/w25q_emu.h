@@ -0,0 +1,58 @@
+/*
+ * File:   w25q_emu.h
+ * Author: N Mark
+ *
+ * W25Q32JV emulator for host builds, backed by a memory mapped image file.
+ *
+ * Command set: read (0x03), fast read (0x0B), page program (0x02), sector,
+ * 32KB and 64KB block and chip erase (0x20, 0x52, 0xD8, 0xC7/0x60), write
+ * enable/disable (0x06/0x04), status registers 1-3 (0x05/0x35/0x15 and
+ * 0x01/0x31/0x11), erase/program suspend and resume (0x75/0x7A), power-down
+ * and release (0xB9/0xAB), JEDEC ID (0x9F), SFDP (0x5A) and reset
+ * (0x66/0x99). Images over 16MB also take 4-byte address mode (0xB7/0xE9).
+ *
+ * Like the part, an instruction is executed on the rising chip select, and
+ * programming only clears bits. Every program, erase and status write keeps
+ * BUSY set for its typical (or maximum, see w25q_open) time on the host
+ * clock; instructions sent meanwhile, or without write enable, or to a
+ * powered down part are ignored and counted in w25q_stats_t.
+ *
+ * @NOTE: Block protection (BP, TB, SEC, CMP) is stored but not enforced
+ *
+ */
+
+#ifndef W25Q_EMU_H
+#define	W25Q_EMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define W25Q_SIZE           0x400000UL  // W25Q32JV
+#define W25Q_PAGE_SIZE      0x100
+
+typedef struct w25q_stats {
+    
+    uint32_t reads;         // read and fast read instructions
+    uint32_t programs;      // page programs executed
+    uint32_t erases[4];     // 4KB, 32KB, 64KB and chip erases executed
+    uint32_t suspends;
+    uint64_t bytesRead;
+    uint64_t bytesProgrammed;
+    uint64_t busyNs;        // time spent busy
+    uint32_t setBits;       // programmed bytes that tried to set a 0 bit
+    uint32_t noWel;         // program/erase/status write without write enable
+    uint32_t whileBusy;     // instructions ignored while busy
+    uint32_t whileDown;     // instructions ignored in power-down or before tRES1
+    uint32_t unknown;       // unsupported instructions
+    
+} w25q_stats_t;
+
+bool w25q_open(const char *, uint32_t, bool);
+void w25q_close(void);
+void w25q_select(bool);
+uint8_t w25q_transfer(uint8_t);
+const w25q_stats_t *w25q_stats(void);
+void w25q_resetStats(void);
+void w25q_printStats(void);
+
+#endif	/* W25Q_EMU_H */
@@ -57,17 +57,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=main.c adc.c ac.c W25Q32JV_memory.c sequencer_utils.c spi.c terminalPrint.c
+SOURCEFILES_QUOTED_IF_SPACED=main.c adc.c ac.c W25Q32JV_memory.c sequencer_utils.c spi.c terminalPrint.c calibration.c recorder.c player.c bench.c power.c events.c song.c stack.c trace.c dac.c midi.c gate.c clock.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/main.o ${OBJECTDIR}/adc.o ${OBJECTDIR}/ac.o ${OBJECTDIR}/W25Q32JV_memory.o ${OBJECTDIR}/sequencer_utils.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/terminalPrint.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/main.o.d ${OBJECTDIR}/adc.o.d ${OBJECTDIR}/ac.o.d ${OBJECTDIR}/W25Q32JV_memory.o.d ${OBJECTDIR}/sequencer_utils.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/terminalPrint.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/main.o ${OBJECTDIR}/adc.o ${OBJECTDIR}/ac.o ${OBJECTDIR}/W25Q32JV_memory.o ${OBJECTDIR}/sequencer_utils.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/terminalPrint.o ${OBJECTDIR}/calibration.o ${OBJECTDIR}/recorder.o ${OBJECTDIR}/player.o ${OBJECTDIR}/bench.o ${OBJECTDIR}/power.o ${OBJECTDIR}/events.o ${OBJECTDIR}/song.o ${OBJECTDIR}/stack.o ${OBJECTDIR}/trace.o ${OBJECTDIR}/dac.o ${OBJECTDIR}/midi.o ${OBJECTDIR}/gate.o ${OBJECTDIR}/clock.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/main.o.d ${OBJECTDIR}/adc.o.d ${OBJECTDIR}/ac.o.d ${OBJECTDIR}/W25Q32JV_memory.o.d ${OBJECTDIR}/sequencer_utils.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/terminalPrint.o.d ${OBJECTDIR}/calibration.o.d ${OBJECTDIR}/recorder.o.d ${OBJECTDIR}/player.o.d ${OBJECTDIR}/bench.o.d ${OBJECTDIR}/power.o.d ${OBJECTDIR}/events.o.d ${OBJECTDIR}/song.o.d ${OBJECTDIR}/stack.o.d ${OBJECTDIR}/trace.o.d ${OBJECTDIR}/dac.o.d ${OBJECTDIR}/midi.o.d ${OBJECTDIR}/gate.o.d ${OBJECTDIR}/clock.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/main.o ${OBJECTDIR}/adc.o ${OBJECTDIR}/ac.o ${OBJECTDIR}/W25Q32JV_memory.o ${OBJECTDIR}/sequencer_utils.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/terminalPrint.o
+OBJECTFILES=${OBJECTDIR}/main.o ${OBJECTDIR}/adc.o ${OBJECTDIR}/ac.o ${OBJECTDIR}/W25Q32JV_memory.o ${OBJECTDIR}/sequencer_utils.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/terminalPrint.o ${OBJECTDIR}/calibration.o ${OBJECTDIR}/recorder.o ${OBJECTDIR}/player.o ${OBJECTDIR}/bench.o ${OBJECTDIR}/power.o ${OBJECTDIR}/events.o ${OBJECTDIR}/song.o ${OBJECTDIR}/stack.o ${OBJECTDIR}/trace.o ${OBJECTDIR}/dac.o ${OBJECTDIR}/midi.o ${OBJECTDIR}/gate.o ${OBJECTDIR}/clock.o
 
 # Source Files
-SOURCEFILES=main.c adc.c ac.c W25Q32JV_memory.c sequencer_utils.c spi.c terminalPrint.c
+SOURCEFILES=main.c adc.c ac.c W25Q32JV_memory.c sequencer_utils.c spi.c terminalPrint.c calibration.c recorder.c player.c bench.c power.c events.c song.c stack.c trace.c dac.c midi.c gate.c clock.c
 
 
 CFLAGS=
@@ -135,6 +135,84 @@ ${OBJECTDIR}/terminalPrint.o: terminalPrint.c  nbproject/Makefile-${CND_CONF}.mk
 	@${RM} ${OBJECTDIR}/terminalPrint.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/terminalPrint.o.d" -MT "${OBJECTDIR}/terminalPrint.o.d" -MT ${OBJECTDIR}/terminalPrint.o -o ${OBJECTDIR}/terminalPrint.o terminalPrint.c 
 	
+${OBJECTDIR}/calibration.o: calibration.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/calibration.o.d 
+	@${RM} ${OBJECTDIR}/calibration.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/calibration.o.d" -MT "${OBJECTDIR}/calibration.o.d" -MT ${OBJECTDIR}/calibration.o -o ${OBJECTDIR}/calibration.o calibration.c 
+	
+${OBJECTDIR}/recorder.o: recorder.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/recorder.o.d 
+	@${RM} ${OBJECTDIR}/recorder.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/recorder.o.d" -MT "${OBJECTDIR}/recorder.o.d" -MT ${OBJECTDIR}/recorder.o -o ${OBJECTDIR}/recorder.o recorder.c 
+	
+${OBJECTDIR}/player.o: player.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/player.o.d 
+	@${RM} ${OBJECTDIR}/player.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/player.o.d" -MT "${OBJECTDIR}/player.o.d" -MT ${OBJECTDIR}/player.o -o ${OBJECTDIR}/player.o player.c 
+	
+${OBJECTDIR}/bench.o: bench.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/bench.o.d 
+	@${RM} ${OBJECTDIR}/bench.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/bench.o.d" -MT "${OBJECTDIR}/bench.o.d" -MT ${OBJECTDIR}/bench.o -o ${OBJECTDIR}/bench.o bench.c 
+	
+${OBJECTDIR}/power.o: power.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/power.o.d 
+	@${RM} ${OBJECTDIR}/power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/power.o.d" -MT "${OBJECTDIR}/power.o.d" -MT ${OBJECTDIR}/power.o -o ${OBJECTDIR}/power.o power.c 
+	
+${OBJECTDIR}/events.o: events.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/events.o.d 
+	@${RM} ${OBJECTDIR}/events.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/events.o.d" -MT "${OBJECTDIR}/events.o.d" -MT ${OBJECTDIR}/events.o -o ${OBJECTDIR}/events.o events.c 
+	
+${OBJECTDIR}/song.o: song.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/song.o.d 
+	@${RM} ${OBJECTDIR}/song.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/song.o.d" -MT "${OBJECTDIR}/song.o.d" -MT ${OBJECTDIR}/song.o -o ${OBJECTDIR}/song.o song.c 
+	
+${OBJECTDIR}/stack.o: stack.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/stack.o.d 
+	@${RM} ${OBJECTDIR}/stack.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/stack.o.d" -MT "${OBJECTDIR}/stack.o.d" -MT ${OBJECTDIR}/stack.o -o ${OBJECTDIR}/stack.o stack.c 
+	
+${OBJECTDIR}/trace.o: trace.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/trace.o.d 
+	@${RM} ${OBJECTDIR}/trace.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/trace.o.d" -MT "${OBJECTDIR}/trace.o.d" -MT ${OBJECTDIR}/trace.o -o ${OBJECTDIR}/trace.o trace.c 
+	
+${OBJECTDIR}/dac.o: dac.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/dac.o.d 
+	@${RM} ${OBJECTDIR}/dac.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/dac.o.d" -MT "${OBJECTDIR}/dac.o.d" -MT ${OBJECTDIR}/dac.o -o ${OBJECTDIR}/dac.o dac.c 
+	
+${OBJECTDIR}/midi.o: midi.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/midi.o.d 
+	@${RM} ${OBJECTDIR}/midi.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/midi.o.d" -MT "${OBJECTDIR}/midi.o.d" -MT ${OBJECTDIR}/midi.o -o ${OBJECTDIR}/midi.o midi.c 
+	
+${OBJECTDIR}/gate.o: gate.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/gate.o.d 
+	@${RM} ${OBJECTDIR}/gate.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/gate.o.d" -MT "${OBJECTDIR}/gate.o.d" -MT ${OBJECTDIR}/gate.o -o ${OBJECTDIR}/gate.o gate.c 
+	
+${OBJECTDIR}/clock.o: clock.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/clock.o.d" -MT "${OBJECTDIR}/clock.o.d" -MT ${OBJECTDIR}/clock.o -o ${OBJECTDIR}/clock.o clock.c 
+	
 else
 ${OBJECTDIR}/main.o: main.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}" 
@@ -178,6 +256,84 @@ ${OBJECTDIR}/terminalPrint.o: terminalPrint.c  nbproject/Makefile-${CND_CONF}.mk
 	@${RM} ${OBJECTDIR}/terminalPrint.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/terminalPrint.o.d" -MT "${OBJECTDIR}/terminalPrint.o.d" -MT ${OBJECTDIR}/terminalPrint.o -o ${OBJECTDIR}/terminalPrint.o terminalPrint.c 
 	
+${OBJECTDIR}/calibration.o: calibration.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/calibration.o.d 
+	@${RM} ${OBJECTDIR}/calibration.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/calibration.o.d" -MT "${OBJECTDIR}/calibration.o.d" -MT ${OBJECTDIR}/calibration.o -o ${OBJECTDIR}/calibration.o calibration.c 
+	
+${OBJECTDIR}/recorder.o: recorder.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/recorder.o.d 
+	@${RM} ${OBJECTDIR}/recorder.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/recorder.o.d" -MT "${OBJECTDIR}/recorder.o.d" -MT ${OBJECTDIR}/recorder.o -o ${OBJECTDIR}/recorder.o recorder.c 
+	
+${OBJECTDIR}/player.o: player.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/player.o.d 
+	@${RM} ${OBJECTDIR}/player.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/player.o.d" -MT "${OBJECTDIR}/player.o.d" -MT ${OBJECTDIR}/player.o -o ${OBJECTDIR}/player.o player.c 
+	
+${OBJECTDIR}/bench.o: bench.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/bench.o.d 
+	@${RM} ${OBJECTDIR}/bench.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/bench.o.d" -MT "${OBJECTDIR}/bench.o.d" -MT ${OBJECTDIR}/bench.o -o ${OBJECTDIR}/bench.o bench.c 
+	
+${OBJECTDIR}/power.o: power.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/power.o.d 
+	@${RM} ${OBJECTDIR}/power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/power.o.d" -MT "${OBJECTDIR}/power.o.d" -MT ${OBJECTDIR}/power.o -o ${OBJECTDIR}/power.o power.c 
+	
+${OBJECTDIR}/events.o: events.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/events.o.d 
+	@${RM} ${OBJECTDIR}/events.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/events.o.d" -MT "${OBJECTDIR}/events.o.d" -MT ${OBJECTDIR}/events.o -o ${OBJECTDIR}/events.o events.c 
+	
+${OBJECTDIR}/song.o: song.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/song.o.d 
+	@${RM} ${OBJECTDIR}/song.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/song.o.d" -MT "${OBJECTDIR}/song.o.d" -MT ${OBJECTDIR}/song.o -o ${OBJECTDIR}/song.o song.c 
+	
+${OBJECTDIR}/stack.o: stack.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/stack.o.d 
+	@${RM} ${OBJECTDIR}/stack.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/stack.o.d" -MT "${OBJECTDIR}/stack.o.d" -MT ${OBJECTDIR}/stack.o -o ${OBJECTDIR}/stack.o stack.c 
+	
+${OBJECTDIR}/trace.o: trace.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/trace.o.d 
+	@${RM} ${OBJECTDIR}/trace.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/trace.o.d" -MT "${OBJECTDIR}/trace.o.d" -MT ${OBJECTDIR}/trace.o -o ${OBJECTDIR}/trace.o trace.c 
+	
+${OBJECTDIR}/dac.o: dac.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/dac.o.d 
+	@${RM} ${OBJECTDIR}/dac.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/dac.o.d" -MT "${OBJECTDIR}/dac.o.d" -MT ${OBJECTDIR}/dac.o -o ${OBJECTDIR}/dac.o dac.c 
+	
+${OBJECTDIR}/midi.o: midi.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/midi.o.d 
+	@${RM} ${OBJECTDIR}/midi.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/midi.o.d" -MT "${OBJECTDIR}/midi.o.d" -MT ${OBJECTDIR}/midi.o -o ${OBJECTDIR}/midi.o midi.c 
+	
+${OBJECTDIR}/gate.o: gate.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/gate.o.d 
+	@${RM} ${OBJECTDIR}/gate.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/gate.o.d" -MT "${OBJECTDIR}/gate.o.d" -MT ${OBJECTDIR}/gate.o -o ${OBJECTDIR}/gate.o gate.c 
+	
+${OBJECTDIR}/clock.o: clock.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__  -mdfp="/Applications/microchip/mplabx/v5.20/packs/Microchip/ATmega_DFP/2.0.12"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fpack-struct -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3     -MD -MP -MF "${OBJECTDIR}/clock.o.d" -MT "${OBJECTDIR}/clock.o.d" -MT ${OBJECTDIR}/clock.o -o ${OBJECTDIR}/clock.o clock.c 
+	
 endif
 
 # ------------------------------------------------------------------------------------
@@ -11,23 +11,419 @@
 volatile uint8_t data;
 
 /* 
+ * 
+ * Driver for SPI NOR flash in the W25Q family (W25Q32JV as fitted; 
+ * W25Q64/128/256 and other SFDP parts with 256 byte pages and 4KB 
+ * erases). mem_init probes the JEDEC ID and the SFDP basic parameter 
+ * table and switches parts over 16MB to 4-byte addresses.
  * 
  * SS -> PC3
  * MISO -> PE1
  * MOSI & CLK shared on SPI0ALT2 -> PE0 & PE2 respectively
  *  
+ * The bus is shared with the DAC, which may preempt any transaction at a
+ * byte boundary (see spi.h). Short commands are simply repeated when that
+ * happens; read and page program streams track their position and resume
+ * where they stopped.
+ * 
+ * Long erases run in the background (mem_eraseStart/mem_eraseService). A 
+ * read or page program stream opened meanwhile suspends the erase (0x75) 
+ * and resumes it (0x7A) when the stream ends, so playback never waits for 
+ * an erase to finish. Streams MUST NOT touch the range being erased.
+ * 
+ * Between accesses the flash may be put in power-down (mem_powerDown). The 
+ * next instruction releases it first and waits out tRES1 only if it has 
+ * not passed yet; mem_wake issues the release ahead of an expected access 
+ * so the wait overlaps other work.
+ * 
+ */
+
+static uint8_t memStreamCmd;    // 0x03, 0x0B or 0x02 of the open stream
+static uint32_t memStreamAddr;  // address of the next byte of the stream
+static uint16_t memCrc;         // CRC of the data bytes since mem_crcStart
+static bool memErasing;         // background erase in progress
+static bool memWritable = true; // cleared by mem_init on an unsupported part
+static bool memSuspended;       // background erase suspended by a stream
+static uint32_t memEraseAddr;   // next address to erase
+static uint32_t memEraseEnd;    // end of the range to erase
+static uint16_t memResumedAt;   // bench_now() of the last resume
+static bool memDown;            // in power-down (0xB9)
+static bool memWaking;          // released (0xAB), tRES1 may not be over
+static uint16_t memDownAt;      // bench_now() of the last power-down
+static uint16_t memWokeAt;      // bench_now() of the last release
+static volatile bool memWakeReq;    // release asked for by an ISR
+
+/* W25Q32JV; kept when the probe finds nothing better */
+static mem_geometry_t memGeo = {
+    {0xEF, 0x40, 0x16}, false, 0x400000, 0x100, 0x20, 0x52, 0xD8, true, false
+};
+
+/* CRC-16/CCITT (poly 0x1021, MSB first) of every byte value */
+static const uint16_t memCrcTable[256] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+/* @NAME: mem_sendAddr
+ * 
+ * @DESCRIPTION: Sends a 24-bit address, or a 32-bit one in 4-byte mode, 
+ *               MSB first
+ * 
+ */
+static void mem_sendAddr(uint32_t addr) {
+    if (memGeo.addr4) {
+        SPI0_transmit(addr>>24);
+    }
+    SPI0_transmit((addr>>16) & 0xFF);
+    SPI0_transmit((addr>>8) & 0xFF);
+    SPI0_transmit(addr & 0xFF);
+}
+
+/* @NAME: mem_release
+ * 
+ * @DESCRIPTION: Sends the Release Power-down instruction (0xAB), repeated 
+ *               if preempted
+ * 
+ */
+static void mem_release(void) {
+    do {
+        SPI0_streamOpen(SPI0_FLASH_SS);
+        SPI0_transmit(0xAB);
+    } while (!SPI0_streamClose());
+}
+
+/* @NAME: mem_awake
+ * 
+ * @DESCRIPTION: Makes sure the flash accepts instructions; first thing 
+ *               before any instruction
+ * 
+ * @NOTE: Only busy-waits for what is left of tRES1 after an early mem_wake
+ * 
+ */
+static void mem_awake(void) {
+    if (memDown) {
+        mem_wake();
+    }
+    
+    if (memWaking) {
+        while ((uint16_t)(bench_now() - memWokeAt) < BENCH_US_TO_TICKS(MEM_TRES1_US)) {
+            ;
+        }
+        memWaking = false;
+    }
+}
+
+/* @NAME: mem_command
+ * 
+ * @DESCRIPTION: Sends a single byte instruction, repeated if preempted
+ * 
+ */
+static void mem_command(uint8_t cmd) {
+    mem_awake();
+    do {
+        SPI0_streamOpen(SPI0_FLASH_SS);
+        SPI0_transmit(cmd);
+    } while (!SPI0_streamClose());
+}
+
+/* @NAME: mem_addrCommand
+ * 
+ * @DESCRIPTION: Sends an instruction with an address, repeated if preempted
+ * 
+ * @NOTE: A repeat after the instruction already executed is harmless for 
+ *        erases; the first one cleared the write enable latch
+ * 
+ */
+static void mem_addrCommand(uint8_t cmd, uint32_t addr) {
+    mem_awake();
+    do {
+        SPI0_streamOpen(SPI0_FLASH_SS);
+        SPI0_transmit(cmd);
+        mem_sendAddr(addr);
+    } while (!SPI0_streamClose());
+}
+
+/* @NAME: mem_streamHeader
+ * 
+ * @DESCRIPTION: (Re)opens the current stream at memStreamAddr
+ * 
+ * @NOTE: A preempted page program has already programmed the bytes it got, 
+ *        so it resumes with a new page program after the busy time
+ * 
+ */
+static void mem_streamHeader(void) {
+    mem_awake();
+    do {
+        if (memStreamCmd == 0x02) {
+            mem_waitBusy();
+            mem_writeEnable(true);
+        }
+        
+        SPI0_streamOpen(SPI0_FLASH_SS);
+        SPI0_transmit(memStreamCmd);
+        mem_sendAddr(memStreamAddr);
+        if (memStreamCmd == 0x0B) {
+            SPI0_transmit(0x00); // dummy clocks
+        }
+    } while (SPI0_streamPreempted());
+}
+
+/* @NAME: mem_streamByte
+ * 
+ * @DESCRIPTION: Shifts the next byte of the open stream, resuming it first 
+ *               if it was preempted
+ * 
+ */
+static uint8_t mem_streamByte(uint8_t out) {
+    uint8_t rx;
+    
+    while (!SPI0_streamByte(out, &rx)) {
+        mem_streamHeader();
+    }
+    memStreamAddr++;
+    
+    // the data byte is the one sent when programming, received when reading
+    memCrc = mem_crc16(memCrc, (memStreamCmd == 0x02) ? out : rx);
+    
+    return rx;
+}
+
+/* @NAME: mem_suspend
+ * 
+ * @DESCRIPTION: Suspends a running background erase before a stream
+ * 
+ * @NOTE: A resume followed too soon by another suspend may keep the erase 
+ *        from ever progressing, so MEM_TSUS_US is kept between the two
+ * 
  */
+static void mem_suspend(void) {
+    if (!memErasing || memSuspended || !(mem_readSR1() & 0x01)) {
+        return;
+    }
+    
+    while ((uint16_t)(bench_now() - memResumedAt) < BENCH_US_TO_TICKS(MEM_TSUS_US)) {
+        ;
+    }
+    
+    // busy clears within tSUS; if the erase just finished, 0x75 and the 
+    // 0x7A after it are ignored
+    mem_command(0x75);
+    mem_waitBusy();
+    memSuspended = true;
+}
+
+/* @NAME: mem_resume
+ * 
+ * @DESCRIPTION: Resumes the erase suspended by mem_suspend
+ * 
+ */
+static void mem_resume(void) {
+    if (!memSuspended) {
+        return;
+    }
+    
+    mem_command(0x7A);
+    memResumedAt = bench_now();
+    memSuspended = false;
+}
+
+/* @NAME: mem_sfdpDword
+ * 
+ * @DESCRIPTION: Reads a little endian dword of the SFDP tables (0x5A), 
+ *               repeated if preempted
+ * 
+ * @NOTE: SFDP addresses are 3 bytes in either address mode
+ * 
+ */
+static uint32_t mem_sfdpDword(uint32_t addr) {
+    uint32_t dw;
+    
+    do {
+        SPI0_streamOpen(SPI0_FLASH_SS);
+        SPI0_transmit(0x5A);
+        SPI0_transmit((addr>>16) & 0xFF);
+        SPI0_transmit((addr>>8) & 0xFF);
+        SPI0_transmit(addr & 0xFF);
+        SPI0_transmit(0x00); // dummy clocks
+        dw = SPI0_transmit(0x00);
+        dw |= (uint32_t)SPI0_transmit(0x00) << 8;
+        dw |= (uint32_t)SPI0_transmit(0x00) << 16;
+        dw |= (uint32_t)SPI0_transmit(0x00) << 24;
+    } while (!SPI0_streamClose());
+    
+    return dw;
+}
+
+/* @NAME: mem_probe
+ * 
+ * @DESCRIPTION: Fills memGeo from the JEDEC ID (0x9F) and, if the part has 
+ *               one, the SFDP basic flash parameter table
+ * 
+ * @NOTE: Without SFDP the capacity byte is taken as log2 of the size, as on 
+ *        every W25Q part. Nothing answering keeps the W25Q32JV defaults
+ * 
+ */
+static void mem_probe(void) {
+    uint8_t id[3];
+    uint32_t hdr, ptp, d1, d2, erase = 0;
+    uint8_t n, op;
+    
+    mem_awake();
+    do {
+        SPI0_streamOpen(SPI0_FLASH_SS);
+        SPI0_transmit(0x9F);
+        id[0] = SPI0_transmit(0x00);
+        id[1] = SPI0_transmit(0x00);
+        id[2] = SPI0_transmit(0x00);
+    } while (!SPI0_streamClose());
+    
+    if (id[0] == 0x00 || id[0] == 0xFF) {
+        return;
+    }
+    
+    memGeo.jedec[0] = id[0];
+    memGeo.jedec[1] = id[1];
+    memGeo.jedec[2] = id[2];
+    if (id[2] >= 0x11 && id[2] <= 0x1F) {
+        memGeo.size = 1UL << id[2];
+    }
+    memGeo.fastRead = (id[0] == 0xEF);
+    
+    // "SFDP" signature, then parameter header 0 (basic table, ID 0x00)
+    if (mem_sfdpDword(0x00) != 0x50444653UL) {
+        memGeo.addr4 = memGeo.size > MEM_ADDR3_MAX;
+        return;
+    }
+    hdr = mem_sfdpDword(0x08);
+    ptp = mem_sfdpDword(0x0C) & 0xFFFFFF;
+    if ((hdr & 0xFF) != 0x00 || (hdr >> 24) < 9) {
+        memGeo.addr4 = memGeo.size > MEM_ADDR3_MAX;
+        return;
+    }
+    
+    memGeo.sfdp = true;
+    memGeo.fastRead = true;
+    
+    // dword 1: 4KB erase support and opcode
+    d1 = mem_sfdpDword(ptp);
+    memGeo.erase4k = ((d1 & 0x03) == 0x01) ? (d1 >> 8) & 0xFF : 0;
+    
+    // dword 2: density in bits, N + 1 or 2^N
+    d2 = mem_sfdpDword(ptp + 4);
+    if (d2 & 0x80000000UL) {
+        memGeo.size = 1UL << ((d2 & 0x7FFFFFFFUL) - 3);
+    } else {
+        memGeo.size = (d2 + 1) >> 3;
+    }
+    
+    // dwords 8-9: four erase types, size 2^N and opcode
+    memGeo.erase32k = 0;
+    memGeo.erase64k = 0;
+    for (uint8_t t = 0; t < 4; t++) {
+        if ((t & 0x01) == 0) {
+            erase = mem_sfdpDword(ptp + 28 + 2 * t);
+        }
+        n = (erase >> (16 * (t & 0x01))) & 0xFF;
+        op = (erase >> (16 * (t & 0x01) + 8)) & 0xFF;
+        if (n == 12 && !memGeo.erase4k) {
+            memGeo.erase4k = op;
+        } else if (n == 15) {
+            memGeo.erase32k = op;
+        } else if (n == 16) {
+            memGeo.erase64k = op;
+        }
+    }
+    
+    // dword 11 (JESD216A on): page size 2^N
+    if ((hdr >> 24) >= 11) {
+        memGeo.pageSize = 1 << ((mem_sfdpDword(ptp + 40) >> 4) & 0x0F);
+    }
+    
+    memGeo.addr4 = memGeo.size > MEM_ADDR3_MAX;
+}
+
+/* @NAME: mem_geometry
+ * 
+ * @DESCRIPTION: Returns the geometry found by mem_init
+ * 
+ */
+const mem_geometry_t *mem_geometry(void) {
+    return &memGeo;
+}
 
 /* @NAME: mem_init
  * 
  * @DESCRIPTION: Initializes memory writing operations
  *               
  * @NOTE: It seems this write enable must occur before any others...
+ *        The flash is released from power-down and 4-byte mode first, a 
+ *        reset of the MCU alone may have left it in either. The probe 
+ *        result is printed via USART3. A part without 256 byte pages or a 
+ *        4KB erase is left read only: the write enable latch is never set 
+ *        again, so the part ignores every program and erase
  * 
  */
 void mem_init(void) {
+    char buff[11] = {0};
+    
+    mem_release();
+    _delay_us(MEM_TRES1_US);
+    mem_command(0xE9);  // exit 4-byte mode; ignored by 3-byte parts
+    
+    mem_probe();
+    
+    if (memGeo.addr4) {
+        // some parts want the write enable latch set for 0xB7
+        mem_writeEnable(true);
+        mem_command(0xB7);
+    }
+    
     /* seems necessary for writing to work properly */
     mem_writeEnable(false);
+    
+    USART3_sendString("flash ");
+    for (uint8_t i = 0; i < 3; i++) {
+        USART3_sendHex(memGeo.jedec[i]);
+        USART3_sendString(" ");
+    }
+    ultoa(memGeo.size >> 10, buff, 10);
+    USART3_sendString(buff);
+    USART3_sendString(memGeo.sfdp ? "KB sfdp" : "KB");
+    if (memGeo.pageSize != MEM_PAGE_SIZE || memGeo.erase4k == 0) {
+        memWritable = false;
+        USART3_sendString(" unsupported, read only");
+    }
+    USART3_sendString("\n\r");
 }
 
 /* @NAME: mem_writeEnable
@@ -41,13 +437,14 @@ void mem_init(void) {
  * 
  */
 void mem_writeEnable(bool toggle) {
-    SPI0_select(0x23, 1);
     if (toggle) {
-        SPI0_transmit(0x06); // write enable 
+        if (!memWritable) {
+            return;
+        }
+        mem_command(0x06); // write enable 
     } else {
-        SPI0_transmit(0x04); // write disable
+        mem_command(0x04); // write disable
     }
-    SPI0_select(0x23, 0);
     
 }
 
@@ -59,60 +456,37 @@ void mem_writeEnable(bool toggle) {
  *          stAddr:   starting address of write operation
  *          dataWord: word sized value to write to flash
  * 
- * @NOTE: A write enable MUST occur directly prior to execution of this instruction.
- *        Must be started at an even address, or only first byte will write
+ * @NOTE: Must be started at an even address, or only first byte will write
  * 
  */
 void mem_pageProgramWord(uint32_t stAddr, uint16_t dataWord) {
     
-    uint8_t addr_l = stAddr & 0xFF;
-    uint8_t addr_m = (stAddr>>8) & 0xFF;
-    uint8_t addr_h = (stAddr>>16);
-    
-    uint8_t dataWord_l = dataWord & 0xFF;
-    uint8_t dataWord_h = dataWord>>8;
-    
-    mem_writeEnable(true);
+    mem_pageProgramInit(stAddr);
+    mem_pageProgramData(dataWord>>8);
+    mem_pageProgramData(dataWord & 0xFF);
+    mem_pageProgramEnd();
     
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0x02);
-    SPI0_transmit(addr_h);
-    SPI0_transmit(addr_m);
-    SPI0_transmit(addr_l);
-    SPI0_transmit(dataWord_h);
-    SPI0_transmit(dataWord_l);
-    SPI0_select(0x23, 0);
-    
-    mem_waitBusy();
-    
-    mem_writeEnable(false);
 }
 
 /* @NAME: mem_pageProgramInit
  * 
- * @DESCRIPTION: First step in a loopable write operation. Sends instruction and start address.
+ * @DESCRIPTION: First step in a loopable write operation. Sends write enable,
+ *               instruction and start address.
  *               
  * @PARAM: 
  *          stAddr: starting address of write operation
  * 
- * @NOTE: A write enable MUST occur directly prior to execution of this instruction.
- *        NOT A STANDALONE FUNCTION. MUST be followed by mem_pageProgramData, 
- *        SPI0_select(0x23, 0), mem_waitBusy, and mem_writeEnable(false);
+ * @NOTE: NOT A STANDALONE FUNCTION. MUST be followed by mem_pageProgramData 
+ *        and mem_pageProgramEnd
  * 
  */
 void mem_pageProgramInit(uint32_t stAddr) {
     
-    uint8_t addr_l = stAddr & 0xFF;
-    uint8_t addr_m = (stAddr>>8) & 0xFF;
-    uint8_t addr_h = (stAddr>>16);
+    mem_suspend();
     
-    mem_writeEnable(true);
-    
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0x02);
-    SPI0_transmit(addr_h);
-    SPI0_transmit(addr_m);
-    SPI0_transmit(addr_l);
+    memStreamCmd = 0x02;
+    memStreamAddr = stAddr;
+    mem_streamHeader();
 
 }
 
@@ -127,11 +501,31 @@ void mem_pageProgramInit(uint32_t stAddr) {
  * 
  * @NOTE: NOT A STANDALONE FUNCTION. 
  *        MUST be used after mem_pageProgramInit and MUST be followed by 
- *        SPI0_select(0x23, 0), mem_waitBusy, and mem_writeEnable(false);
+ *        mem_pageProgramEnd
  *        
  */
 void mem_pageProgramData(uint8_t data) {
-    SPI0_transmit(data);
+    mem_streamByte(data);
+}
+
+/* @NAME: mem_pageProgramEnd
+ * 
+ * @DESCRIPTION: Final step in a loopable write operation. Deselects the chip,
+ *               which starts the program cycle, and waits for it to finish.
+ *               
+ * @NOTE: NOT A STANDALONE FUNCTION. 
+ *        MUST be used after mem_pageProgramInit and mem_pageProgramData
+ *        
+ */
+void mem_pageProgramEnd(void) {
+    // every byte is latched by now, even if a DAC frame raised CS first
+    SPI0_streamClose();
+    
+    mem_waitBusy();
+    
+    mem_writeEnable(false);
+    
+    mem_resume();
 }
 
 /* @NAME: mem_readInit
@@ -142,7 +536,7 @@ void mem_pageProgramData(uint8_t data) {
  *          stAddr: starting address of read operation
  * 
  * @NOTE: NOT A STANDALONE FUNCTION. 
- *        MUST be followed by mem_readData and SPI0_select(0x23, 0)
+ *        MUST be followed by mem_readData and mem_readEnd
  * 
  * @EG:
  *          mem_readInit(0x003000);
@@ -151,19 +545,33 @@ void mem_pageProgramData(uint8_t data) {
  *              mem_readData(); 
  *          }   
  *      
- *          SPI0_select(0x23, 0);
+ *          mem_readEnd();
  * 
  */
 void mem_readInit(uint32_t stAddr) {
-    uint8_t addr_l = stAddr & 0xFF;
-    uint8_t addr_m = (stAddr>>8) & 0xFF;
-    uint8_t addr_h = (stAddr>>16);
-    
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0x03);
-    SPI0_transmit(addr_h);
-    SPI0_transmit(addr_m);
-    SPI0_transmit(addr_l);
+    mem_suspend();
+    memStreamCmd = 0x03;
+    memStreamAddr = stAddr;
+    mem_streamHeader();
+}
+
+/* @NAME: mem_fastReadInit
+ * 
+ * @DESCRIPTION: First step in a loopable Fast Read operation. Sends instruction,
+ *               start address and the dummy byte.
+ *               
+ * @PARAM: 
+ *          stAddr: starting address of read operation
+ * 
+ * @NOTE: NOT A STANDALONE FUNCTION. 
+ *        MUST be followed by mem_readData and mem_readEnd
+ * 
+ */
+void mem_fastReadInit(uint32_t stAddr) {
+    mem_suspend();
+    memStreamCmd = memGeo.fastRead ? 0x0B : 0x03;
+    memStreamAddr = stAddr;
+    mem_streamHeader();
 }
 
 /* @NAME: mem_readData
@@ -173,15 +581,25 @@ void mem_readInit(uint32_t stAddr) {
  *               Address auto-incremented.       
  * 
  * @NOTE: NOT A STANDALONE FUNCTION.
- *        MUST be used after mem_readInit and MUST be followed by 
- *        SPI0_select(0x23, 0)
+ *        MUST be used after mem_readInit or mem_fastReadInit and MUST be 
+ *        followed by mem_readEnd
  * 
  */
 uint8_t mem_readData(void) {
-    data = SPI0_transmit(0x00);
+    data = mem_streamByte(0x00);
     return data;
 }
 
+/* @NAME: mem_readEnd
+ * 
+ * @DESCRIPTION: Final step in a loopable read operation. Deselects the chip.
+ * 
+ */
+void mem_readEnd(void) {
+    SPI0_streamClose();
+    mem_resume();
+}
+
 /* @NAME: mem_display
  * 
  * @DESCRIPTION: Displays memory locations between start and stop addresses 
@@ -202,7 +620,23 @@ void mem_display(uint32_t stAddr, uint32_t endAddr, char* buffer) {
         USART3_sendString("\n\r");
     }
     
-    SPI0_select(0x23, 0);
+    mem_readEnd();
+}
+
+/* @NAME: mem_readSR
+ * 
+ * @DESCRIPTION: Reads a status register, repeated if preempted
+ * 
+ */
+static uint8_t mem_readSR(uint8_t cmd) {
+    mem_awake();
+    do {
+        SPI0_streamOpen(SPI0_FLASH_SS);
+        SPI0_transmit(cmd);
+        data = SPI0_transmit(0x00);
+    } while (!SPI0_streamClose());
+    
+    return data;
 }
 
 /* @NAME: mem_readSRx
@@ -213,28 +647,13 @@ void mem_display(uint32_t stAddr, uint32_t endAddr, char* buffer) {
  * 
  */
 uint8_t mem_readSR1(void) {
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0x05);
-    data = SPI0_transmit(0x00);
-    SPI0_select(0x23, 0);
-    
-    return data;
+    return mem_readSR(0x05);
 }
 uint8_t mem_readSR2(void) {
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0x35);
-    data = SPI0_transmit(0x00);
-    SPI0_select(0x23, 0);
-    
-    return data;
+    return mem_readSR(0x35);
 }
 uint8_t mem_readSR3(void) {
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0x15);
-    data = SPI0_transmit(0x00);
-    SPI0_select(0x23, 0);
-    
-    return data;
+    return mem_readSR(0x15);
 }
 
 /* @NAME: mem_waitBusy
@@ -246,35 +665,28 @@ uint8_t mem_readSR3(void) {
  */
 void mem_waitBusy(void) {
     volatile uint8_t status = 1;
-    SPI0_select(0x23, 1);
     
     while (status & 0x01) {
         status = mem_readSR1();
     }
     
-    SPI0_select(0x23, 0);
-    
 }
 
 /* @NAME: mem_waitBusy
  * 
  * @DESCRIPTION: Utility to clear a 4KB sector of memory at the starting address.       
  * 
- * @NOTE: Erased state is 0xFF
+ * @NOTE: Erased state is 0xFF. Waits for the block a background erase is 
+ *        on, which then carries on with the rest of its range
  * 
  */
 void mem_sectorErase(uint32_t stAddr) {
-    uint8_t addr_l = stAddr & 0xFF;
-    uint8_t addr_m = (stAddr>>8) & 0xFF;
-    uint8_t addr_h = (stAddr>>16);
-    
+    if (!memWritable) {
+        return;
+    }
+    mem_waitBusy();
     mem_writeEnable(true);
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0x20);
-    SPI0_transmit(addr_h);
-    SPI0_transmit(addr_m);
-    SPI0_transmit(addr_l);
-    SPI0_select(0x23, 0);
+    mem_addrCommand(memGeo.erase4k, stAddr);
     
     mem_waitBusy();
     mem_writeEnable(false);
@@ -284,15 +696,236 @@ void mem_sectorErase(uint32_t stAddr) {
  * 
  * @DESCRIPTION: Utility to clear entire memory chip.       
  * 
- * @NOTE: Cleared state is 0xFF
+ * @NOTE: Cleared state is 0xFF. Blocks for tens of seconds; prefer 
+ *        mem_eraseStart over the range actually needed. Replaces any 
+ *        background erase
  * 
  */
 void mem_erase(void) {
+    mem_waitBusy();
+    memErasing = false;
     mem_writeEnable(true);
-    SPI0_select(0x23, 1);
-    SPI0_transmit(0xC7);
-    SPI0_select(0x23, 0);
+    mem_command(0xC7);
     
     mem_waitBusy();
     mem_writeEnable(false);
 }
+
+/* @NAME: mem_crc16
+ * 
+ * @DESCRIPTION: Adds a byte to a CRC-16/CCITT; one table lookup
+ * 
+ */
+uint16_t mem_crc16(uint16_t crc, uint8_t data) {
+    return (crc << 8) ^ pgm_read_word(&memCrcTable[(crc >> 8) ^ data]);
+}
+
+/* @NAME: mem_crcStart
+ * 
+ * @DESCRIPTION: Restarts the CRC kept over every data byte streamed by 
+ *               mem_readData and mem_pageProgramData
+ * 
+ * @NOTE: The CRC is updated as the bytes are shifted, so checking what was 
+ *        read or written takes no second pass over the flash
+ * 
+ */
+void mem_crcStart(void) {
+    memCrc = MEM_CRC_INIT;
+}
+
+/* @NAME: mem_crc
+ * 
+ * @DESCRIPTION: Returns the CRC of the data bytes since mem_crcStart
+ * 
+ */
+uint16_t mem_crc(void) {
+    return memCrc;
+}
+
+/* @NAME: mem_eraseBlock
+ * 
+ * @DESCRIPTION: Picks the largest erase that starts at addr and stays 
+ *               within left bytes
+ * 
+ * @PARAM: 
+ *          addr: sector aligned address
+ *          left: bytes left to erase, a multiple of MEM_SECTOR_SIZE
+ *          size: returns the bytes the erase clears
+ * 
+ * @NOTE: Returns the instruction: 0xD8 (64KB), 0x52 (32KB) or 0x20 (4KB) 
+ *        on the W25Q family; block sizes the part lacks are skipped
+ * 
+ */
+static uint8_t mem_eraseBlock(uint32_t addr, uint32_t left, uint32_t *size) {
+    if (memGeo.erase64k && (addr & (MEM_BLOCK64_SIZE - 1)) == 0 
+            && left >= MEM_BLOCK64_SIZE) {
+        *size = MEM_BLOCK64_SIZE;
+        return memGeo.erase64k;
+    }
+    if (memGeo.erase32k && (addr & (MEM_BLOCK32_SIZE - 1)) == 0 
+            && left >= MEM_BLOCK32_SIZE) {
+        *size = MEM_BLOCK32_SIZE;
+        return memGeo.erase32k;
+    }
+    *size = MEM_SECTOR_SIZE;
+    return memGeo.erase4k;
+}
+
+/* @NAME: mem_eraseStart
+ * 
+ * @DESCRIPTION: Starts erasing a byte range in the background with the 
+ *               fewest 4KB/32KB/64KB erases
+ *               
+ * @PARAM: 
+ *          stAddr: first byte to erase
+ *          len:    bytes to erase; the range is widened to whole sectors
+ * 
+ * @NOTE: Returns false if a background erase is already running. The work 
+ *        is done by mem_eraseService, one block at a time
+ * 
+ */
+bool mem_eraseStart(uint32_t stAddr, uint32_t len) {
+    if (memErasing) {
+        return false;
+    }
+    
+    memEraseEnd = (stAddr + len + MEM_SECTOR_SIZE - 1) & ~(uint32_t)(MEM_SECTOR_SIZE - 1);
+    memEraseAddr = stAddr & ~(uint32_t)(MEM_SECTOR_SIZE - 1);
+    memErasing = true;
+    
+    return true;
+}
+
+/* @NAME: mem_eraseService
+ * 
+ * @DESCRIPTION: Issues the next block of a background erase once the 
+ *               previous one is done; called from the main loop
+ * 
+ * @NOTE: Never waits on the flash. A 64KB block takes 150ms typ (2s max), 
+ *        a 4KB sector 45ms typ
+ * 
+ */
+void mem_eraseService(void) {
+    uint32_t size;
+    uint8_t cmd;
+    
+    if (!memErasing || (mem_readSR1() & 0x01)) {
+        return;
+    }
+    
+    if (memEraseAddr == memEraseEnd || !memWritable) {
+        memErasing = false;
+        return;
+    }
+    
+    cmd = mem_eraseBlock(memEraseAddr, memEraseEnd - memEraseAddr, &size);
+    mem_writeEnable(true);
+    mem_addrCommand(cmd, memEraseAddr);
+    memEraseAddr += size;
+}
+
+/* @NAME: mem_eraseRange
+ * 
+ * @DESCRIPTION: Erases a byte range with the fewest 4KB/32KB/64KB erases 
+ *               and returns when it is done
+ * 
+ * @NOTE: Finishes any background erase first
+ * 
+ */
+void mem_eraseRange(uint32_t stAddr, uint32_t len) {
+    while (memErasing) {
+        mem_eraseService();
+    }
+    
+    mem_eraseStart(stAddr, len);
+    
+    while (memErasing) {
+        mem_eraseService();
+    }
+}
+
+/* @NAME: mem_writable
+ * 
+ * @DESCRIPTION: Returns false if mem_init found a part it cannot program 
+ *               or erase
+ * 
+ */
+bool mem_writable(void) {
+    return memWritable;
+}
+
+/* @NAME: mem_erasing
+ * 
+ * @DESCRIPTION: Returns true while a background erase is in progress
+ * 
+ */
+bool mem_erasing(void) {
+    return memErasing;
+}
+
+/* @NAME: mem_powerDown
+ * 
+ * @DESCRIPTION: Puts the flash in power-down (0xB9); called when no 
+ *               service is about to use it
+ * 
+ * @NOTE: Not while a background erase runs; the flash ignores 0xB9 while 
+ *        busy and mem_eraseService has to poll it. An early mem_wake is 
+ *        kept until the access it was made for
+ * 
+ */
+void mem_powerDown(void) {
+    if (memDown || memErasing || memWaking) {
+        return;
+    }
+    
+    mem_command(0xB9);
+    memDownAt = bench_now();
+    memDown = true;
+}
+
+/* @NAME: mem_wake
+ * 
+ * @DESCRIPTION: Releases the flash from power-down without waiting for 
+ *               tRES1; the next instruction waits for what is left of it
+ * 
+ * @NOTE: main loop only. Call it ahead of an expected access
+ * 
+ */
+void mem_wake(void) {
+    if (!memDown) {
+        return;
+    }
+    
+    // 0xAB is only accepted once the device is in power-down
+    while ((uint16_t)(bench_now() - memDownAt) < BENCH_US_TO_TICKS(MEM_TDP_US)) {
+        ;
+    }
+    
+    mem_release();
+    memWokeAt = bench_now();
+    memWaking = true;
+    memDown = false;
+}
+
+/* @NAME: mem_wakeSoon
+ * 
+ * @DESCRIPTION: Asks the main loop to release the flash at the top of its 
+ *               next pass; safe to call from an ISR
+ * 
+ */
+void mem_wakeSoon(void) {
+    memWakeReq = true;
+}
+
+/* @NAME: mem_wakeService
+ * 
+ * @DESCRIPTION: Issues a release asked for by mem_wakeSoon; first call of 
+ *               the main loop, so tRES1 runs while the other services work
+ * 
+ */
+void mem_wakeService(void) {
+    if (memWakeReq) {
+        memWakeReq = false;
+        mem_wake();
+    }
+}
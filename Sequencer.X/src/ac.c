@@ -28,7 +28,11 @@ void AC0redge_init(void){
     
     /* output on PA7 currently disabled */
     AC0.CTRLA = AC_ENABLE_bm    /* Enable analog comparator */
-              | AC_INTMODE_POSEDGE_gc;    /* RISING EDGE enabled */
+              | AC_INTMODE_POSEDGE_gc     /* RISING EDGE enabled */
+              | AC_RUNSTDBY_bm;           /* gate wakes the CPU from standby */
     
     AC0.INTCTRL = AC_CMP_bm;    /* Analog Comparator 0 Interrupt enabled */
+    
+    /* gate edge preempts the sample tick; DAC frames are atomic (see spi.h) */
+    CPUINT.LVL1VEC = AC0_AC_vect_num;
 }
\ No newline at end of file
@@ -6,6 +6,19 @@
 
 #include "adc.h"
 
+/*
+ * Background scan state. adcTable holds the latest decimated result of
+ * every slot (AIN0-7, then the CV input); it is written by ADC0_scanNext()
+ * from the RESRDY interrupt
+ */
+static volatile uint16_t adcTable[ADC_SCAN_SLOTS];
+static volatile uint8_t adcRate[ADC_MAX_CHANNEL] = ADC_SCAN_RATES;
+static uint8_t adcDue[ADC_MAX_CHANNEL]; // CV results until a channel is due
+static uint8_t adcSlot;                 // slot being converted
+static uint8_t adcPot;                  // round-robin position among AIN0-7
+static volatile uint8_t adcSeq;         // bumped on every new CV result
+static bool adcPaused;                  // chain stopped by ADC0_scanPause
+
 void ADC0mux_init(void){
     
     /*
@@ -70,6 +83,8 @@ void ADC0free_init()
    ADC0.CTRLC = ADC_PRESC_DIV2_gc     //CLK_PER divided by 2
               | ADC_REFSEL_VDDREF_gc; //VDD Reference
 
+   ADC0.CTRLB = ADC_SAMPNUM_OVS_gc;   //Accumulate 4^ADC_OVERSAMPLE_BITS samples
+
    ADC0.CTRLA = ADC_ENABLE_bm         //ADC Enable: enabled
               | ADC_RESSEL_10BIT_gc   //10 bit mode
               | ADC_FREERUN_bm;       //Enable Free Run Mode
@@ -78,6 +93,54 @@ void ADC0free_init()
    
 }
 
+/* Starts the background scan of the CV input and of every AIN0-7 channel
+ * with a non-zero rate in ADC_SCAN_RATES.
+ * 
+ * Single conversions are chained from the RESRDY interrupt, every result
+ * accumulated over 4^ADC_OVERSAMPLE_BITS samples. The CV input is converted
+ * at least every other result; a channel with rate n is converted once per
+ * n CV results, in round-robin order when several are due.
+ */
+void ADC0scan_init(void)
+{
+
+   PORTF.PIN3CTRL &= ~PORT_ISC_gm;      //Disable digital input buffer
+   PORTF.PIN3CTRL |= PORT_ISC_INPUT_DISABLE_gc;
+   PORTF.PIN3CTRL &= ~PORT_PULLUPEN_bm; //Disable Pull-up Resistor
+
+   for (uint8_t ch = 0; ch < ADC_MAX_CHANNEL; ch++) {
+      if (adcRate[ch]) {
+         ADC0_pinInit(ch);
+      }
+      adcDue[ch] = adcRate[ch];
+   }
+
+   ADC0.CTRLC = ADC_PRESC_DIV2_gc     //CLK_PER divided by 2
+              | ADC_REFSEL_VDDREF_gc; //VDD Reference
+
+   ADC0.CTRLB = ADC_SAMPNUM_OVS_gc;   //Accumulate 4^ADC_OVERSAMPLE_BITS samples
+
+   ADC0.CTRLA = ADC_ENABLE_bm         //ADC Enable: enabled
+              | ADC_RESSEL_10BIT_gc;  //10 bit mode, single conversions
+
+   ADC0.INTCTRL = ADC_RESRDY_bm;      //Result ready interrupt -> ADC0_scanNext
+
+   adcSlot = ADC_CH_CV;
+   ADC0_mux(ADC_MUXPOS_AIN13_gc);
+   ADC0_start();
+   
+}
+
+/* Disables the digital input buffer and pull-up of an AIN0-7 pin (PORTD).
+ */
+void ADC0_pinInit(uint8_t ch)
+{
+   register8_t *pinctrl = &PORTD.PIN0CTRL + ch;
+
+   *pinctrl = (*pinctrl & ~(PORT_ISC_gm | PORT_PULLUPEN_bm))
+            | PORT_ISC_INPUT_DISABLE_gc;
+}
+
 uint8_t ADC0mux_read(void){
     
     //start ADC conversion cycle
@@ -119,3 +182,143 @@ void ADC0_mux(uint8_t n){
     return;
     
 }
+
+/* Picks the AIN0-7 channel to convert after a CV result.
+ * 
+ * Returns ADC_CH_CV when no channel is due.
+ */
+static uint8_t ADC0_scanDue(void){
+   uint8_t next = ADC_CH_CV;
+   uint8_t ch;
+
+   for (uint8_t i = 0; i < ADC_MAX_CHANNEL; i++) {
+      ch = (adcPot + i) & (ADC_MAX_CHANNEL - 1);
+      if (!adcRate[ch]) {
+         continue;
+      }
+      if (adcDue[ch]) {
+         adcDue[ch]--;
+      }
+      if (!adcDue[ch] && next == ADC_CH_CV) {
+         next = ch;
+      }
+   }
+
+   if (next != ADC_CH_CV) {
+      adcDue[next] = adcRate[next];
+      adcPot = (next + 1) & (ADC_MAX_CHANNEL - 1);
+   }
+
+   return next;
+}
+
+/* Stores the decimated result of a finished accumulation and starts the
+ * next conversion of the scan.
+ * 
+ * Called from the RESRDY interrupt; reading RES clears the flag. The store
+ * is atomic, so the level 1 gate interrupt never sees a torn value.
+ */
+void ADC0_scanNext(void){
+   uint16_t val = ADC0.RES >> ADC_OVERSAMPLE_BITS;
+   uint8_t sreg = SREG;
+
+   cli();
+   adcTable[adcSlot] = val;
+   SREG = sreg;
+
+   if (adcSlot == ADC_CH_CV) {
+      adcSeq++;
+      adcSlot = ADC0_scanDue();
+   } else {
+      adcSlot = ADC_CH_CV;
+   }
+
+   if (adcSlot == ADC_CH_CV) {
+      ADC0_mux(ADC_MUXPOS_AIN13_gc);
+   } else {
+      ADC0_mux(ADC_MUXPOS_AIN0_gc + adcSlot);
+   }
+   ADC0_start();
+}
+
+/* Returns the latest ADC_RESULT_BITS result of a scan slot without waiting.
+ * 
+ * Safe from any context; never extends an ISR by a conversion.
+ */
+uint16_t ADC0_value(uint8_t slot){
+   uint16_t val;
+   uint8_t sreg = SREG;
+
+   cli();
+   val = adcTable[slot];
+   SREG = sreg;
+
+   return val;
+}
+
+/* Returns the latest ADC_RESULT_BITS result of the CV input.
+ */
+uint16_t ADC0_latest(void){
+   return ADC0_value(ADC_CH_CV);
+}
+
+/* Sets how often an AIN0-7 channel is scanned: once per rate CV results,
+ * 0 to stop scanning it.
+ */
+void ADC0_setRate(uint8_t ch, uint8_t rate){
+   if (rate && !adcRate[ch]) {
+      ADC0_pinInit(ch);
+   }
+   adcRate[ch] = rate;
+}
+
+/* Stops the scan chain: the conversion in flight finishes but starts no
+ * other, so RESRDY no longer wakes the CPU.
+ * 
+ * Main loop only. The result of that conversion is dropped on resume.
+ */
+void ADC0_scanPause(void){
+   ADC0.INTCTRL = 0;
+   adcPaused = true;
+}
+
+/* Restarts a paused scan with the slot it stopped on.
+ * 
+ * The conversion is started again even if it finished or was aborted by
+ * standby (the ADC does not run in standby), so the chain always resumes.
+ * The table holds the results from before the pause until the new ones
+ * come in. Does nothing if the scan runs.
+ */
+void ADC0_scanResume(void){
+   if (!adcPaused) {
+      return;
+   }
+   adcPaused = false;
+
+   ADC0.INTFLAGS = ADC_RESRDY_bm;
+   ADC0_start();
+   ADC0.INTCTRL = ADC_RESRDY_bm;
+}
+
+/* Waits for a fresh CV result and returns it.
+ * 
+ * With interrupts disabled (e.g. during boot) the scan is advanced by
+ * polling instead of by the RESRDY interrupt.
+ */
+uint16_t ADC0_next(void){
+   uint8_t seq;
+
+   ADC0_scanResume();
+   seq = adcSeq;
+
+   if (!(SREG & CPU_I_bm)) {
+      while (adcSeq == seq) {
+         while (!ADC0_conversionDone());
+         ADC0_scanNext();
+      }
+   } else {
+      while (adcSeq == seq);
+   }
+
+   return ADC0_latest();
+}
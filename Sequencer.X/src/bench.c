@@ -0,0 +1,139 @@
+/*
+ * File:   bench.c
+ * Author: N Mark
+ *
+ * TCB3 free-running timestamp for on-target measurements, and the SPI0
+ * profile throughput check.
+ */
+
+#include "sequencer_utils.h"
+#include "bench.h"
+
+/* @NAME: bench_init
+ *
+ * @DESCRIPTION: Starts TCB3 as a free-running 16-bit counter on CLK_PER
+ *
+ * @NOTE: No interrupt; periodic mode with CCMP at the top of the range
+ *
+ */
+void bench_init(void) {
+
+    TCB3.CCMP = 0xFFFF;
+    TCB3.CTRLB = TCB_CNTMODE_INT_gc;
+    TCB3.CTRLA = TCB_CLKSEL_CLKDIV1_gc | TCB_ENABLE_bm;
+
+    return;
+
+}
+
+/* @NAME: bench_now
+ *
+ * @DESCRIPTION: Returns the current timestamp in CLK_PER ticks
+ *
+ */
+uint16_t bench_now(void) {
+    return TCB3.CNT;
+}
+
+/* @NAME: bench_spiReport
+ *
+ * @DESCRIPTION: Prints a bus's nominal SCK, the measured payload rate and
+ *               how much of the nominal byte rate that is
+ *
+ * @PARAM:
+ *          name:    label
+ *          nominal: bytes per second at the bus's SCK
+ *          bytes:   payload moved
+ *          ticks:   bench_now() ticks it took
+ *
+ */
+static void bench_spiReport(char *name, uint32_t nominal, uint16_t bytes, uint16_t ticks) {
+
+    uint32_t rate;
+    char buff[11] = {0};
+
+    rate = (uint32_t)bytes * F_CPU / ticks;
+
+    USART3_sendString("spi ");
+    USART3_sendString(name);
+    USART3_sendString(": sck ");
+    ultoa(nominal * 8 / 1000, buff, 10);
+    USART3_sendString(buff);
+    USART3_sendString("kHz, ");
+    ultoa(rate, buff, 10);
+    USART3_sendString(buff);
+    USART3_sendString("B/s, ");
+    USART3_sendWord(rate * 100 / nominal);
+    USART3_sendString("% of the bus, ");
+    USART3_sendWord(BENCH_TICKS_TO_US(ticks));
+    USART3_sendString("us\n\r");
+
+}
+
+/* @NAME: bench_spi
+ *
+ * @DESCRIPTION: Measures the DAC and flash buses as the firmware drives
+ *               them and prints the results via USART3:
+ *               - dac:   BENCH_SPI_FRAMES back-to-back frames
+ *               - call:  time sendDacRaw keeps its caller, bus idle
+ *               - flash: a Fast Read of one page
+ *               - mixed: the same page with a DAC frame every
+ *                        BENCH_SPI_MIX bytes; on SPI0 each frame preempts
+ *                        the stream, with DAC_USART they overlap
+ *
+ * @NOTE: DAC frames are code 0 through sendDacRaw, the output is 0V then
+ *        anyway. Flash rates count the page only, the command headers
+ *        are in the time. Compare a build with and without DAC_USART.
+ *        MUST run before sei() with bench_init and mem_init already done
+ *
+ */
+void bench_spi(void) {
+
+    uint16_t t0, t;
+    uint32_t dacRate, flashRate;
+
+#ifdef DAC_USART
+    dacRate = DAC_SCK_HZ / 8;
+#else
+    dacRate = F_CPU / SPI0_byteClocks(SPI0_DAC_SS);
+#endif
+    flashRate = F_CPU / SPI0_byteClocks(SPI0_FLASH_SS);
+
+    t0 = bench_now();
+    for (uint8_t i = 0; i < BENCH_SPI_FRAMES; i++) {
+        sendDacRaw(0);
+    }
+    t = bench_now() - t0;
+    bench_spiReport("dac", dacRate, 2 * BENCH_SPI_FRAMES, t);
+
+    t0 = bench_now();
+    sendDacRaw(0);
+    t = bench_now() - t0;
+    USART3_sendString("spi call: ");
+    USART3_sendWord(t);
+    USART3_sendString(" ticks\n\r");
+
+    t0 = bench_now();
+    mem_fastReadInit(MEM_CONTEXT_ADDR);
+    for (uint16_t i = 0; i < MEM_PAGE_SIZE; i++) {
+        mem_readData();
+    }
+    mem_readEnd();
+    t = bench_now() - t0;
+    bench_spiReport("flash", flashRate, MEM_PAGE_SIZE, t);
+
+    t0 = bench_now();
+    mem_fastReadInit(MEM_CONTEXT_ADDR);
+    for (uint16_t i = 0; i < MEM_PAGE_SIZE; i++) {
+        if ((i & (BENCH_SPI_MIX - 1)) == 0) {
+            sendDacRaw(0);
+        }
+        mem_readData();
+    }
+    mem_readEnd();
+    t = bench_now() - t0;
+    bench_spiReport("mixed", flashRate, MEM_PAGE_SIZE, t);
+
+    return;
+
+}
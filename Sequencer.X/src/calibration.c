@@ -0,0 +1,224 @@
+/*
+ * File:   calibration.c
+ * Author: N Mark
+ *
+ * Two-point calibration of the CV input (ADC) and CV output (MCP4922),
+ * folded into a single ADC code -> DAC code lookup table.
+ */
+
+#include "sequencer_utils.h"
+#include "calibration.h"
+
+uint16_t calTable[CAL_TABLE_SIZE + 1];
+
+/* @NAME: cal_init
+ *
+ * @DESCRIPTION: Loads the calibration table on boot, or runs the calibration
+ *               procedure when the save button (PC0, PC1 with DAC_USART) is
+ *               held during power-up
+ *
+ * @NOTE: MUST run after io_init, USART3_init, ADC0scan_init, mem_init and
+ *        dac_init (with DAC_USART)
+ *
+ */
+void cal_init(void) {
+
+#ifdef DAC_USART
+    if (!(PORTC.IN & PIN1_bm)) {
+#else
+    if (!(PORTC.IN & PIN0_bm)) {
+#endif
+        cal_run();
+    } else {
+        cal_load();
+    }
+
+    return;
+
+}
+
+/* @NAME: cal_sendMv
+ *
+ * @DESCRIPTION: Prints a millivolt value via USART3
+ *
+ */
+static void cal_sendMv(uint16_t mv) {
+    USART3_sendWord(mv);
+    USART3_sendString("mV");
+}
+
+/* @NAME: cal_averageInput
+ *
+ * @DESCRIPTION: Averages CAL_SAMPLES fresh samples of the CV input
+ *
+ */
+static uint16_t cal_averageInput(void) {
+    uint32_t sum = 0;
+
+    for (uint8_t i = 0; i < CAL_SAMPLES; i++) {
+        sum += ADC0_next();
+    }
+
+    return sum / CAL_SAMPLES;
+}
+
+/* @NAME: cal_run
+ *
+ * @DESCRIPTION: Interactive calibration over USART3. Two known voltages are
+ *               applied to the CV input, then two DAC output voltages are
+ *               measured and typed in. The resulting table is stored in flash.
+ *
+ * @NOTE: All the math happens here, once; the table maps each ADC code
+ *        straight to the DAC code that reproduces the same voltage
+ *
+ */
+void cal_run(void) {
+
+    uint16_t adcLo, adcHi, mvLo, mvHi;
+    int32_t mv, code;
+
+    USART3_sendString("\n\rCV calibration\n\rApply ");
+    cal_sendMv(CAL_IN_LO_MV);
+    USART3_sendString(" to the CV input, then press any key\n\r");
+    USART3_read();
+    adcLo = cal_averageInput();
+
+    USART3_sendString("Apply ");
+    cal_sendMv(CAL_IN_HI_MV);
+    USART3_sendString(" to the CV input, then press any key\n\r");
+    USART3_read();
+    adcHi = cal_averageInput();
+
+    sendDacRaw(CAL_DAC_LO_CODE);
+    USART3_sendString("Enter the measured CV output in mV: ");
+    mvLo = USART3_readNum();
+
+    sendDacRaw(CAL_DAC_HI_CODE);
+    USART3_sendString("\n\rEnter the measured CV output in mV: ");
+    mvHi = USART3_readNum();
+    USART3_sendString("\n\r");
+
+    if (adcHi <= adcLo || mvHi <= mvLo) {
+        USART3_sendString("Calibration failed; keeping stored table\n\r");
+        cal_load();
+        return;
+    }
+
+    for (uint16_t idx = 0; idx <= CAL_TABLE_SIZE; idx++) {
+        // ADC code -> input voltage
+        mv = CAL_IN_LO_MV + (((int32_t)idx << CAL_TABLE_SHIFT) - adcLo)
+                * (CAL_IN_HI_MV - CAL_IN_LO_MV) / (adcHi - adcLo);
+        // input voltage -> DAC code producing the same output voltage
+        code = CAL_DAC_LO_CODE + (mv - mvLo)
+                * (CAL_DAC_HI_CODE - CAL_DAC_LO_CODE) / (mvHi - mvLo);
+
+        if (code < 0) {
+            code = 0;
+        } else if (code > CAL_DAC_MAX_CODE) {
+            code = CAL_DAC_MAX_CODE;
+        }
+
+        calTable[idx] = code;
+    }
+
+    cal_store();
+
+    USART3_sendString("Calibration stored\n\r");
+
+    return;
+
+}
+
+/* @NAME: cal_load
+ *
+ * @DESCRIPTION: Loads the calibration table from flash into SRAM
+ *
+ * @NOTE: Without a stored table the identity mapping is used, i.e. ADC codes
+ *        go to the DAC unchanged (the uncalibrated behaviour). Tables stored
+ *        for a different layout carry another magic word and are ignored
+ *
+ */
+void cal_load(void) {
+
+    uint16_t magic;
+    uint32_t code;
+
+    mem_readInit(MEM_CAL_ADDR);
+    magic = mem_readData() << 8;
+    magic += mem_readData();
+    mem_readEnd();
+
+    if (magic == CAL_MAGIC) {
+        mem_readInit(MEM_CAL_ADDR + MEM_PAGE_SIZE);
+        for (uint16_t idx = 0; idx <= CAL_TABLE_SIZE; idx++) {
+            calTable[idx] = mem_readData() << 8;
+            calTable[idx] += mem_readData();
+        }
+        mem_readEnd();
+    } else {
+        for (uint16_t idx = 0; idx <= CAL_TABLE_SIZE; idx++) {
+            code = (uint32_t)idx << CAL_TABLE_SHIFT;
+            calTable[idx] = (code > CAL_DAC_MAX_CODE) ? CAL_DAC_MAX_CODE : code;
+        }
+    }
+
+    return;
+
+}
+
+/* @NAME: cal_store
+ *
+ * @DESCRIPTION: Stores the calibration table in flash
+ *
+ * @NOTE: Magic word in the first page at MEM_CAL_ADDR, table (big endian)
+ *        from the second page on
+ *
+ */
+void cal_store(void) {
+
+    uint32_t addr = MEM_CAL_ADDR + MEM_PAGE_SIZE;
+
+    mem_sectorErase(MEM_CAL_ADDR);
+
+    // table first, so a torn store never leaves a valid magic word behind
+    for (uint16_t idx = 0; idx <= CAL_TABLE_SIZE; idx++) {
+        if ((addr & (MEM_PAGE_SIZE - 1)) == 0) {
+            mem_pageProgramInit(addr);
+        }
+
+        mem_pageProgramData(calTable[idx] >> 8);
+        mem_pageProgramData(calTable[idx] & 0xFF);
+        addr += 2;
+
+        if ((addr & (MEM_PAGE_SIZE - 1)) == 0 || idx == CAL_TABLE_SIZE) {
+            mem_pageProgramEnd();
+        }
+    }
+
+    mem_pageProgramWord(MEM_CAL_ADDR, CAL_MAGIC);
+
+    return;
+
+}
+
+/* @NAME: cal_lookup
+ *
+ * @DESCRIPTION: Returns the calibrated DAC code for an ADC_RESULT_BITS code
+ *
+ * @NOTE: Called from the gate and sample ISRs; one table read plus a
+ *        short linear interpolation when the ADC is oversampled
+ *
+ */
+uint16_t cal_lookup(uint16_t adc) {
+
+    uint16_t idx = (adc >> CAL_TABLE_SHIFT) & (CAL_TABLE_SIZE - 1);
+#if CAL_TABLE_SHIFT > 0
+    uint8_t frac = adc & ((1 << CAL_TABLE_SHIFT) - 1);
+    int16_t step = calTable[idx + 1] - calTable[idx];
+
+    return calTable[idx] + ((step * frac) >> CAL_TABLE_SHIFT);
+#else
+    return calTable[idx];
+#endif
+
+}
@@ -0,0 +1,149 @@
+/*
+ * File:   clock.c
+ * Author: N Mark
+ *
+ * Gate clock filter and divider (CLOCK_DIVIDER builds only).
+ */
+
+#include "sequencer_utils.h"
+#include "clock.h"
+
+#if defined(CLOCK_DIVIDER) && defined(MIDI_INPUT)
+#error "CLOCK_DIVIDER divides the gate clock, MIDI_INPUT replaces it"
+#endif
+#if defined(CLOCK_DIVIDER) && defined(GATE_OUTPUT)
+#error "CLOCK_DIVIDER and GATE_OUTPUT both use TCA0"
+#endif
+
+/*
+ * local variables
+ */
+#ifdef CLOCK_DIVIDER
+static uint16_t clockPot;               // pot code of the last division set
+#endif
+
+/* @NAME: clock_init
+ *
+ * @DESCRIPTION: Routes the gate comparator through the CCL filter into
+ *               TCA0 and makes the TCA0 overflow the level 1 interrupt in
+ *               place of the gate
+ *
+ * @NOTE: MUST run with interrupts off, after AC0redge_init and
+ *        ADC0scan_init: the scan is polled until the pot has been
+ *        converted and its position is taken, so a pot left anywhere edits
+ *        nothing until it is turned. Does nothing unless CLOCK_DIVIDER is
+ *        defined
+ *
+ */
+void clock_init(void) {
+
+#ifdef CLOCK_DIVIDER
+    AC0.CTRLA = (AC0.CTRLA & ~AC_HYSMODE_gm) | CLOCK_AC_HYSMODE;
+
+    EVSYS.CHANNEL3 = EVSYS_GENERATOR_AC0_OUT_gc;
+    EVSYS.CHANNEL4 = EVSYS_GENERATOR_CCL_LUT0_gc;
+    EVSYS.USERCCLLUT0A = EVSYS_CHANNEL_CHANNEL3_gc;
+    EVSYS.USERTCA0 = EVSYS_CHANNEL_CHANNEL4_gc;
+
+    // LUT0 = input 0 (event A), filtered; set up with the CCL disabled
+    CCL.CTRLA = 0;
+    CCL.LUT0CTRLB = CCL_INSEL0_EVENTA_gc | CCL_INSEL1_MASK_gc;
+    CCL.LUT0CTRLC = CCL_INSEL2_MASK_gc;
+    CCL.TRUTH0 = 0xAA;
+    CCL.LUT0CTRLA = CCL_FILTSEL_FILTER_gc | CCL_ENABLE_bm;
+    CCL.CTRLA = CCL_ENABLE_bm;
+
+    // rising edges of the filtered clock are the count
+    TCA0.SINGLE.CNT = 0;
+    TCA0.SINGLE.PER = 0;
+    TCA0.SINGLE.EVCTRL = TCA_SINGLE_EVACT_POSEDGE_gc | TCA_SINGLE_CNTEI_bm;
+    TCA0.SINGLE.INTFLAGS = TCA_SINGLE_OVF_bm;
+    TCA0.SINGLE.INTCTRL = TCA_SINGLE_OVF_bm;
+    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV1_gc | TCA_SINGLE_ENABLE_bm;
+
+    // the divided clock steps, not the gate
+    AC0.INTCTRL = 0;
+    CPUINT.LVL1VEC = TCA0_OVF_vect_num;
+
+    for (uint8_t i = 0; i < CLOCK_POT_SETTLE; i++) {
+        ADC0_next();
+    }
+    clockPot = ADC0_value(CLOCK_POT_SLOT);
+#endif
+
+    return;
+
+}
+
+/* @NAME: clock_setDiv
+ *
+ * @DESCRIPTION: Sets the gate edges per step; called by clockStep with the
+ *               division of the pattern that plays next
+ *
+ * @PARAM:
+ *          div: 1 to CLOCK_DIV_MAX
+ *
+ * @NOTE: Runs right after the overflow, with TCA0 at BOTTOM, so PER can be
+ *        written directly and the next step already counts to it. A
+ *        division out of range leaves PER as it is
+ *
+ */
+void clock_setDiv(uint8_t div) {
+
+#ifdef CLOCK_DIVIDER
+    if (div == 0 || div > CLOCK_DIV_MAX) {
+        return;
+    }
+    TCA0.SINGLE.PER = div - 1;
+#else
+    (void)div;
+#endif
+
+    return;
+
+}
+
+/* @NAME: clock_service
+ *
+ * @DESCRIPTION: Sets the current pattern's clock division from the pot;
+ *               called from the main loop
+ *
+ * @NOTE: Moves smaller than CLOCK_POT_HYST are ignored. The division set
+ *        is traced (TRACE_DIV_POT), the pot is not
+ *
+ */
+void clock_service(void) {
+
+#ifdef CLOCK_DIVIDER
+    uint16_t pot = ADC0_value(CLOCK_POT_SLOT);
+    uint8_t div;
+
+    if (pot + CLOCK_POT_HYST > clockPot && pot < clockPot + CLOCK_POT_HYST) {
+        return;
+    }
+    clockPot = pot;
+
+    div = 1 + (((uint32_t)pot * CLOCK_DIV_MAX) >> ADC_RESULT_BITS);
+    TRACE_EVENT(TRACE_DIV_POT, div);
+    setClockDiv(div);
+#endif
+
+    return;
+
+}
+
+/* @NAME: clock_busy
+ *
+ * @DESCRIPTION: Returns true when the divider needs the CPU clock, i.e. in
+ *               every CLOCK_DIVIDER build; TCA0 does not count in standby
+ *
+ */
+bool clock_busy(void) {
+
+#ifdef CLOCK_DIVIDER
+    return true;
+#else
+    return false;
+#endif
+
+}
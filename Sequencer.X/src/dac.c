@@ -0,0 +1,133 @@
+/*
+ * File:   dac.c
+ * Author: N Mark
+ *
+ * MCP4922 on USART1 in host SPI mode (DAC_USART builds only).
+ */
+
+#include "sequencer_utils.h"
+#include "dac.h"
+
+/*
+ * local variables
+ */
+#ifdef DAC_USART
+static volatile bool dacBusy;           // frame shifting, chip select low
+#endif
+
+/* @NAME: dac_init
+ *
+ * @DESCRIPTION: Configures USART1 as the DAC's host SPI (mode 0, MSB
+ *               first, DAC_SCK_HZ, transmitter only) and the chip select
+ *
+ * @NOTE: Does nothing unless DAC_USART is defined
+ *
+ */
+void dac_init(void) {
+
+#ifdef DAC_USART
+    PORTE.OUTSET = DAC_CS_bm;
+    PORTE.DIRSET = DAC_CS_bm;
+
+    // XCK idles low in mode 0
+    PORTC.OUTCLR = PIN0_bm | PIN2_bm;
+    PORTC.DIRSET = PIN0_bm | PIN2_bm;
+    PORTMUX.USARTROUTEA = (PORTMUX.USARTROUTEA & ~PORTMUX_USART1_gm)
+            | PORTMUX_USART1_DEFAULT_gc;
+
+    USART1.BAUD = DAC_BAUD;
+    USART1.CTRLC = USART_CMODE_MSPI_gc;
+    USART1.CTRLA = USART_TXCIE_bm;
+    USART1.CTRLB = USART_TXEN_bm;
+#endif
+
+    return;
+
+}
+
+/* @NAME: dac_write
+ *
+ * @DESCRIPTION: Starts a 16-bit frame and returns while it shifts
+ *
+ * @PARAM:
+ *          high: first byte of the frame
+ *          low:  second byte of the frame
+ *
+ * @NOTE: Safe from any ISR. Interrupts are off while it runs, so a frame
+ *        still on the bus is finished here rather than by its ISR. Called
+ *        with interrupts disabled (boot, calibration) it waits for the
+ *        frame and latches it itself, since no ISR would
+ *
+ */
+void dac_write(uint8_t high, uint8_t low) {
+
+#ifdef DAC_USART
+    uint8_t sreg = SREG;
+
+    cli();
+    while (dacBusy) {
+        if (USART1.STATUS & USART_TXCIF_bm) {
+            dac_txc();
+        }
+    }
+
+    PORTE.OUTCLR = DAC_CS_bm;
+    dacBusy = true;
+
+    // both bytes fit the transmit buffer (shifter + TXDATA)
+    USART1.TXDATAL = high;
+    while (!(USART1.STATUS & USART_DREIF_bm)) {
+        ;
+    }
+    USART1.TXDATAL = low;
+
+    if (!(sreg & CPU_I_bm)) {
+        while (!(USART1.STATUS & USART_TXCIF_bm)) {
+            ;
+        }
+        dac_txc();
+    }
+    SREG = sreg;
+#else
+    (void)high;
+    (void)low;
+#endif
+
+    return;
+
+}
+
+/* @NAME: dac_txc
+ *
+ * @DESCRIPTION: Ends the frame on the bus: raises the chip select (the
+ *               MCP4922 latches its output) and clears the flag; called
+ *               from the USART1 TXC ISR
+ *
+ */
+void dac_txc(void) {
+
+#ifdef DAC_USART
+    PORTE.OUTSET = DAC_CS_bm;
+    USART1.STATUS = USART_TXCIF_bm;
+    dacBusy = false;
+#endif
+
+    return;
+
+}
+
+/* @NAME: dac_busy
+ *
+ * @DESCRIPTION: Returns true while a frame is shifting; nothing may sleep
+ *               below idle then
+ *
+ */
+bool dac_busy(void) {
+
+#ifdef DAC_USART
+    return dacBusy;
+#else
+    return false;
+#endif
+
+}
@@ -0,0 +1,112 @@
+/*
+ * File:   events.c
+ * Author: N Mark
+ *
+ * Lock-free SPSC event queues between the port ISRs and the main loop.
+ *
+ * Each side owns one index: the producer only writes evtHead, the
+ * consumer only writes evtTail. Both are single bytes, so every access is
+ * atomic and no interrupts need to be disabled on either side.
+ */
+
+#include "sequencer_utils.h"
+#include "events.h"
+
+/*
+ * local variables
+ */
+static event_t evtQueue[EVT_PRIOS][EVT_QUEUE_SIZE];
+static volatile uint8_t evtHead[EVT_PRIOS];     // next slot to write (producer)
+static volatile uint8_t evtTail[EVT_PRIOS];     // next slot to read (consumer)
+static volatile uint8_t evtDropped;             // events lost to a full queue
+
+/* @NAME: evt_post
+ *
+ * @DESCRIPTION: Queues an event; called from the port ISRs
+ *
+ * @PARAM:
+ *          prio: EVT_PRIO_* queue
+ *          type: EVT_* type
+ *          data: captured pin state
+ *
+ * @NOTE: Returns false and counts the event as dropped if the queue is full
+ *
+ */
+bool evt_post(uint8_t prio, uint8_t type, uint8_t data) {
+
+    uint8_t head = evtHead[prio];
+
+    if ((uint8_t)(head - evtTail[prio]) == EVT_QUEUE_SIZE) {
+        evtDropped++;
+        return false;
+    }
+
+    evtQueue[prio][head & (EVT_QUEUE_SIZE - 1)].type = type;
+    evtQueue[prio][head & (EVT_QUEUE_SIZE - 1)].data = data;
+
+    // publish only once the entry is complete
+    evtHead[prio] = head + 1;
+
+    return true;
+
+}
+
+/* @NAME: evt_get
+ *
+ * @DESCRIPTION: Takes the oldest event of the highest priority non-empty
+ *               queue; called from the main loop
+ *
+ * @NOTE: Returns false when all queues are empty
+ *
+ */
+bool evt_get(event_t *evt) {
+
+    uint8_t tail;
+
+    for (uint8_t prio = 0; prio < EVT_PRIOS; prio++) {
+        tail = evtTail[prio];
+        if (tail != evtHead[prio]) {
+            *evt = evtQueue[prio][tail & (EVT_QUEUE_SIZE - 1)];
+            evtTail[prio] = tail + 1;
+            return true;
+        }
+    }
+
+    return false;
+
+}
+
+/* @NAME: evt_pending
+ *
+ * @DESCRIPTION: Returns true if any queue holds an event
+ *
+ */
+bool evt_pending(void) {
+
+    for (uint8_t prio = 0; prio < EVT_PRIOS; prio++) {
+        if (evtTail[prio] != evtHead[prio]) {
+            return true;
+        }
+    }
+
+    return false;
+
+}
+
+/* @NAME: evt_dropped
+ *
+ * @DESCRIPTION: Returns and clears the number of dropped events
+ *
+ */
+uint8_t evt_dropped(void) {
+
+    uint8_t n;
+
+    cli();
+    n = evtDropped;
+    evtDropped = 0;
+    sei();
+
+    return n;
+
+}
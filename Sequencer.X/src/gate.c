@@ -0,0 +1,173 @@
+/*
+ * File:   gate.c
+ * Author: N Mark
+ *
+ * Gate and trigger outputs (GATE_OUTPUT builds only).
+ *
+ * The clock period needs no overflow interrupt either: every edge moves
+ * TCA0's CMP0 to one tick behind the counter, so its flag is set exactly
+ * when a whole wrap has passed since that edge.
+ */
+
+#include "sequencer_utils.h"
+#include "gate.h"
+
+#define GATE_STROBE         (1 << EVSYS_GATE_CHANNEL)
+
+/*
+ * local variables
+ */
+#ifdef GATE_OUTPUT
+static uint16_t gateEdge;               // TCA0 count at the last clock edge
+static uint16_t gatePeriod;             // last measured clock period, 0 before one
+static uint16_t gatePot;                // pot code of the last gate set
+#endif
+
+/* @NAME: gate_init
+ *
+ * @DESCRIPTION: Starts the TCA0 timebase and sets up TCB0/TCB1 as single
+ *               shot pulse generators on PF4/PF5, armed by a software event
+ *
+ * @NOTE: MUST run with interrupts off, after ADC0scan_init: the scan is
+ *        polled until the pot has been converted and its position is
+ *        taken, so a pot left anywhere edits nothing until it is turned.
+ *        Does nothing unless GATE_OUTPUT is defined
+ *
+ */
+void gate_init(void) {
+
+#ifdef GATE_OUTPUT
+    PORTF.OUTCLR = PIN4_bm | PIN5_bm;
+    PORTF.DIRSET = PIN4_bm | PIN5_bm;
+    PORTMUX.TCBROUTEA |= PORTMUX_TCB0_bm | PORTMUX_TCB1_bm;
+
+    TCA0.SINGLE.PER = 0xFFFF;
+    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV256_gc | TCA_SINGLE_ENABLE_bm;
+
+    // output high from the event until CCMP, then the timer stops
+    TCB0.CCMP = 0;
+    TCB0.CTRLB = TCB_CNTMODE_SINGLE_gc | TCB_CCMPEN_bm;
+    TCB0.EVCTRL = TCB_CAPTEI_bm;
+    TCB0.CTRLA = TCB_CLKSEL_CLKTCA_gc | TCB_ENABLE_bm;
+
+    TCB1.CCMP = GATE_TRIG_TICKS;
+    TCB1.CTRLB = TCB_CNTMODE_SINGLE_gc | TCB_CCMPEN_bm;
+    TCB1.EVCTRL = TCB_CAPTEI_bm;
+    TCB1.CTRLA = TCB_CLKSEL_CLKTCA_gc | TCB_ENABLE_bm;
+
+    // no generator: the channel only carries EVSYS.STROBE
+    EVSYS.USERTCB0 = EVSYS_CHANNEL_CHANNEL0_gc + EVSYS_GATE_CHANNEL;
+    EVSYS.USERTCB1 = EVSYS_CHANNEL_CHANNEL0_gc + EVSYS_GATE_CHANNEL;
+
+    for (uint8_t i = 0; i < GATE_POT_SETTLE; i++) {
+        ADC0_next();
+    }
+    gatePot = ADC0_value(GATE_POT_SLOT);
+#endif
+
+    return;
+
+}
+
+/* @NAME: gate_clock
+ *
+ * @DESCRIPTION: Measures the clock period and arms the step's pulses;
+ *               called by clockStep on every clock
+ *
+ * @PARAM:
+ *          hit: the step plays (false on a Euclidean rest)
+ *
+ * @NOTE: The current step's gate is read from currPattern. A timer still
+ *        running is restarted from BOTTOM instead of strobed, which keeps
+ *        its output high (a tie). CNT is cleared before RUN is looked at,
+ *        so a pulse ending in between is strobed again, never lost
+ *
+ */
+void gate_clock(bool hit) {
+
+#ifdef GATE_OUTPUT
+    uint16_t now = TCA0.SINGLE.CNT;
+    uint32_t len;
+    uint8_t pct;
+
+    // a wrap or more since the last edge: stopped or too slow to measure
+    if (!(TCA0.SINGLE.INTFLAGS & TCA_SINGLE_CMP0_bm)) {
+        gatePeriod = now - gateEdge;
+    }
+    gateEdge = now;
+    TCA0.SINGLE.CMP0 = now - 1;
+    TCA0.SINGLE.INTFLAGS = TCA_SINGLE_CMP0_bm;
+
+    if (!hit || !gatePeriod) {
+        return;
+    }
+
+    // (100 - pct) % off the period, no division; a tie runs over the next
+    // edge by GATE_TIE_SLACK, which a late clock must not reach
+    pct = currPattern->steps[status.currStepIdx].gate;
+    if (pct >= GATE_MAX) {
+        len = (uint32_t)gatePeriod + (gatePeriod >> GATE_TIE_SLACK);
+        TCB0.CCMP = (len > 0xFFFF) ? 0xFFFF : len;
+    } else {
+        TCB0.CCMP = gatePeriod - (((uint32_t)gatePeriod * ((GATE_MAX - pct) * 655u)) >> 16);
+    }
+
+    // one strobe starts whichever timer is stopped, a running one ignores it
+    TCB0.CNT = 0;
+    TCB1.CNT = 0;
+    if ((TCB0.STATUS & TCB1.STATUS & TCB_RUN_bm) == 0) {
+        EVSYS.STROBE = GATE_STROBE;
+    }
+#else
+    (void)hit;
+#endif
+
+    return;
+
+}
+
+/* @NAME: gate_service
+ *
+ * @DESCRIPTION: Sets the gate of the step last touched with a step button
+ *               from the gate pot; called from the main loop
+ *
+ * @NOTE: Moves smaller than GATE_POT_HYST are ignored. The gate set is
+ *        traced (TRACE_GATE_POT), the pot is not
+ *
+ */
+void gate_service(void) {
+
+#ifdef GATE_OUTPUT
+    uint16_t pot = ADC0_value(GATE_POT_SLOT);
+    uint8_t pct;
+
+    if (pot + GATE_POT_HYST > gatePot && pot < gatePot + GATE_POT_HYST) {
+        return;
+    }
+    gatePot = pot;
+
+    pct = GATE_MIN + (((uint32_t)pot * (GATE_MAX - GATE_MIN + 1)) >> ADC_RESULT_BITS);
+    TRACE_EVENT(TRACE_GATE_POT, pct);
+    setStepGate(pct);
+#endif
+
+    return;
+
+}
+
+/* @NAME: gate_busy
+ *
+ * @DESCRIPTION: Returns true when the outputs need the CPU clock, i.e. in
+ *               every GATE_OUTPUT build; standby stops the TCA0 timebase
+ *               and with it any pulse
+ *
+ */
+bool gate_busy(void) {
+
+#ifdef GATE_OUTPUT
+    return true;
+#else
+    return false;
+#endif
+
+}
@@ -20,6 +20,7 @@
  * local variables
  */
 volatile uint8_t intflags; // variable for clearing interrupt flags
+event_t evt;               // event being handled by the main loop
 
 int main(void) {
 
@@ -27,24 +28,99 @@ int main(void) {
 //    rtc_pit_init();
     /* SPI0 Initalizer */
     SPI0_init(2);
+    SPI0_slaveInit(SPI0_FLASH_SS);
+    /* SPI0 profiles - clock and mode per slave, applied on its select */
+    SPI0_profile(SPI0_FLASH_SS, SPI0_FLASH_CLOCK, SPI0_FLASH_MODE);
+#ifdef DAC_USART
+    /* DAC on its own bus - USART1 host SPI, see dac.h */
+    dac_init();
+#else
+    SPI0_slaveInit(SPI0_DAC_SS);
+    SPI0_profile(SPI0_DAC_SS, SPI0_DAC_CLOCK, SPI0_DAC_MODE);
+#endif
     /* PORT IO initializer */
     io_init();
     /* USART Initializer */
     USART3_init();
-    /* ADC Initializer - on PORTD pin 6 */
-    ADC0free_init();
+    /* ADC Initializer - CV input on PORTF pin 3 and pots, scanned in the background */
+    ADC0scan_init();
     /* AC Initializer */
     AC0redge_init();
     /* W25Q32JV memory initializer */
     mem_init();
-    /* Sequencer initializer */    
-    restoreContext();
+    /* Calibration table loader - hold save button on boot to recalibrate */
+    cal_init();
+    /* Song chain loader - hold record button on boot to enter a song */
+    song_init();
+    /* Gate recorder initializer - TCB2 sample tick, slot lengths */
+    rec_init();
+    /* Benchmark timestamp - TCB3 */
+    bench_init();
+    /* Sleep control, gate wake-up latency capture */
+    pwr_init();
+    /* Event trace - TCB3 wrap count, TRACE_START */
+    trace_init();
+    /* MIDI clock input - USART2 on PF1, replaces the gate as the clock */
+    midi_init();
+    /* Gate and trigger outputs - TCA0 timebase, TCB0/TCB1 pulses on PF4/PF5 */
+    gate_init();
+    /* Clock filter and divider - CCL LUT0 and TCA0 step the pattern */
+    clock_init();
+#ifdef SPI_BENCHMARK
+    bench_spi();
+#endif
+#ifdef PLAY_BENCHMARK
+    play_benchmark();
+#endif
+    /* Sequencer initializer - hold playback button on boot for factory reset */    
+    if (!(PORTD.IN & PIN4_bm)) {
+        factoryReset();
+    } else {
+        restoreContext();
+    }
     
     sei();
    
+    /* Event loop - all timing critical work happens in the ISRs */
     while(1)
     {
-        ;
+        /* flash release asked for by an ISR, overlaps the work below */
+        mem_wakeService();
+        /* front panel work posted by the port ISRs, by priority */
+        while (evt_get(&evt)) {
+            handleEvent(&evt);
+        }
+        if (evt_dropped()) {
+            USART3_sendString("events dropped\n\r");
+        }
+        /* stages the next song entry ahead of its downbeat */
+        song_service();
+        /* page programs for full-gate recordings */
+        rec_service();
+        /* Fast Read refills for full-gate playback */
+        play_service();
+        /* next block of a background erase (factory reset) */
+        mem_eraseService();
+        /* walk to a MIDI song position */
+        midi_service();
+        /* gate length pot */
+        gate_service();
+        /* clock division pot */
+        clock_service();
+#ifdef PWR_LATENCY
+        pwr_report();
+#endif
+#ifdef STACK_MONITOR
+        stack_report();
+#endif
+#ifdef MIDI_JITTER
+        midi_report();
+#endif
+#ifdef TRACE_CAPTURE
+        trace_service();
+#endif
+        /* sleep until the next interrupt unless work is pending */
+        pwr_sleep();
     }
     
     return (EXIT_SUCCESS);
@@ -54,31 +130,91 @@ int main(void) {
 -----------------------------------------------------------------------------
  Interrupt service routines:
  AC0_AC: Analog Comparator interrupt. Runs on rising gate/clock edge
+ TCA0_OVF: Every Nth filtered gate edge, in place of AC0_AC; CLOCK_DIVIDER only
  RTC_PIT: Real time counter periodic interrupt timer interrupt. UNUSED
+ TCB2_INT: Full-gate recording/playback sample tick
+ TCB3_INT: Timestamp wrap, event trace only
+ USART1_TXC: End of a DAC frame, DAC_USART only
+ USART2_RXC: MIDI byte received; clock and transport, MIDI_INPUT only
+ ADC0_RESRDY: Background scan conversion finished, starts the next
  PORTA, PORTB, PORTD, PORTF, PORTC_PORT: Button/rotary encoder interrupts
-                                         Specifics below
+                                         Specifics below; post events only
 -----------------------------------------------------------------------------
 */
 
-ISR(AC0_AC_vect) {
+/* @NAME: clockStep
+ * 
+ * @DESCRIPTION: One sequencer clock: advances the pattern and updates the 
+ *               DAC; the body of the gate ISR, shared with the MIDI clock
+ *               
+ * @PARAM: 
+ *          restart: start the pattern over (MIDI start) instead of stepping
+ * 
+ */
+static void clockStep(bool restart) {
+    
+    bool hit;   // false on a Euclidean rest
+    
+    // pattern edits published since the last step take effect here;
+    // a song boundary switches to the staged entry and starts it over
+    if (song_tick() || restart) {
+        swapPattern();
+        hit = restartPattern();
+    } else {
+        swapPattern();
+        hit = step();
+    }
+    clock_setDiv(currPattern->clockDiv);
     
-    step();
+    // pulses first, they are timed from here
+    gate_clock(hit);
 
     if (status.freeRun) {
         adcVal = oneShotSample();
         sendDacCommand(adcVal);
-        recordSample(adcVal);
-    } else {
+        if (hit) {
+            recordSample(adcVal);
+        }
+    } else if (hit) {
         playbackPattern();
     } 
     
+}
+
+ISR(AC0_AC_vect) {
+    
+    STACK_SAMPLE(STACK_ISR_AC0);
+#ifdef PWR_LATENCY
+    pwr_wakeStamp();
+#endif
+    TRACE_EVENT(TRACE_GATE, 1);
+    clockStep(false);
+    
     /* Clear Int flag */
     AC0.STATUS = AC_CMP_bm;
     
 }
 
+#ifdef CLOCK_DIVIDER
+/* Routine for TCA0 steps on the divided clock; level 1 */
+ISR(TCA0_OVF_vect) {
+    
+    STACK_SAMPLE(STACK_ISR_TCA0);
+#ifdef PWR_LATENCY
+    pwr_wakeStamp();
+#endif
+    TRACE_EVENT(TRACE_GATE, 1);
+    clockStep(false);
+    
+    /* Clear Int flag */
+    TCA0.SINGLE.INTFLAGS = TCA_SINGLE_OVF_bm;
+    
+}
+#endif
+
 ISR(RTC_PIT_vect) {
     
+    STACK_SAMPLE(STACK_ISR_RTC);
     adcVal = oneShotSample();
     sendDacCommand(adcVal);
     recordSample(adcVal);
@@ -89,10 +225,78 @@ ISR(RTC_PIT_vect) {
     
 }
 
+/* Routine for ADC0 stores the result in the scan table, starts the next */
+ISR(ADC0_RESRDY_vect) {
+    
+    STACK_SAMPLE(STACK_ISR_ADC0);
+    // reading the result clears the int flag
+    ADC0_scanNext();
+    
+}
+
+/* Routine for TCB2 handles the full-gate recording/playback sample tick */
+ISR(TCB2_INT_vect) {
+    
+    STACK_SAMPLE(STACK_ISR_TCB2);
+    // at most one of these is active
+    rec_tick();
+    play_tick();
+    
+    // clear int flag
+    TCB2.INTFLAGS = TCB_CAPT_bm;
+    
+}
+
+#ifdef TRACE_CAPTURE
+/* Routine for TCB3 extends the trace timestamp; clears its own flag */
+ISR(TCB3_INT_vect) {
+    
+    STACK_SAMPLE(STACK_ISR_TCB3);
+    trace_wrap();
+    
+}
+#endif
+
+#ifdef DAC_USART
+/* Routine for USART1 ends the DAC frame; dac_txc clears the flag */
+ISR(USART1_TXC_vect) {
+    
+    STACK_SAMPLE(STACK_ISR_USART1);
+    dac_txc();
+    
+}
+#endif
+
+#ifdef MIDI_INPUT
+/* Routine for USART2 parses a MIDI byte and steps on the clock; level 1 */
+ISR(USART2_RXC_vect) {
+    
+    uint8_t c, tick;
+    
+    STACK_SAMPLE(STACK_ISR_USART2);
+    // reading the data clears the int flag
+    c = USART2.RXDATAL;
+    TRACE_EVENT(TRACE_MIDI, c);
+    tick = midi_rx(c);
+    if (tick) {
+        clockStep(tick & MIDI_RESTART);
+        midi_stamp();
+    }
+    
+}
+#endif
+
+/* Port ISRs only capture the pins and post; work is done by handleEvent */
+
 /* Routine for PORTA handles button step toggles */
 ISR(PORTA_PORT_vect) {
     
-    toggleSteps();
+    uint8_t pins;
+    
+    STACK_SAMPLE(STACK_ISR_PORTA);
+    pins = PORTA.IN;
+    TRACE_EVENT(TRACE_PORTA, pins);
+    evt_post(EVT_PRIO_PANEL, EVT_STEP_BUTTONS, ~pins);
     
     intflags = PORTA.INTFLAGS;
     PORTA.INTFLAGS = intflags;
@@ -102,7 +306,12 @@ ISR(PORTA_PORT_vect) {
 /* Routine for PORTB handles program pattern select knob */
 ISR(PORTB_PORT_vect) {
     
-    selectPattern();
+    uint8_t pins;
+    
+    STACK_SAMPLE(STACK_ISR_PORTB);
+    pins = PORTB.IN;
+    TRACE_EVENT(TRACE_PORTB, pins);
+    evt_post(EVT_PRIO_PANEL, EVT_ENCODER, pins);
     
     // clear int flag
     intflags = PORTB.INTFLAGS;
@@ -110,10 +319,15 @@ ISR(PORTB_PORT_vect) {
     
 }
 
-/* Routine for PORTD handles playback enable button */
+/* Routine for PORTD handles playback enable button (both edges) */
 ISR(PORTD_PORT_vect) {
     
-    setPlaybackEnable();
+    uint8_t pins;
+    
+    STACK_SAMPLE(STACK_ISR_PORTD);
+    pins = PORTD.IN;
+    TRACE_EVENT(TRACE_PORTD, pins);
+    evt_post(EVT_PRIO_PANEL, EVT_PLAYBACK_BUTTON, pins);
     
     // clear int flag
     intflags = PORTD.INTFLAGS;
@@ -124,7 +338,9 @@ ISR(PORTD_PORT_vect) {
 /* Routine for PORTF handles record enable button */
 ISR(PORTF_PORT_vect) {
     
-    setRecordEnable();
+    STACK_SAMPLE(STACK_ISR_PORTF);
+    TRACE_EVENT(TRACE_PORTF, PORTF.IN);
+    evt_post(EVT_PRIO_PANEL, EVT_RECORD_BUTTON, 0);
     
     // clear int flag
     intflags = PORTF.INTFLAGS;
@@ -136,7 +352,9 @@ ISR(PORTF_PORT_vect) {
  * Temporary button perhaps? 
  */
 ISR(PORTC_PORT_vect) {
-    saveContext();
+    STACK_SAMPLE(STACK_ISR_PORTC);
+    TRACE_EVENT(TRACE_PORTC, PORTC.IN);
+    evt_post(EVT_PRIO_BULK, EVT_SAVE_BUTTON, 0);
     
     // clear int flag
     intflags = PORTC.INTFLAGS;
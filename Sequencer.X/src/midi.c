@@ -0,0 +1,321 @@
+/*
+ * File:   midi.c
+ * Author: N Mark
+ *
+ * MIDI clock and transport input (MIDI_INPUT builds only).
+ *
+ * Every byte is handled in the USART2 receive ISR as it arrives; at
+ * 31250 baud a byte takes 320us, far longer than the ISR, so the receive
+ * buffer never overruns and nothing has to be queued.
+ */
+
+#include "sequencer_utils.h"
+#include "midi.h"
+
+#if defined(MIDI_JITTER) && (defined(PWR_LATENCY) || defined(TRACE_CAPTURE))
+#error "MIDI_JITTER, PWR_LATENCY and TRACE_CAPTURE all use TCB3"
+#endif
+
+/*
+ * local variables
+ */
+#ifdef MIDI_INPUT
+static uint8_t midiStatus;              // running status, 0 if none
+static uint8_t midiNeed;                // data bytes per message of midiStatus
+static uint8_t midiCount;               // data bytes of the message so far
+static uint8_t midiData;                // first data byte
+static volatile bool midiRunning;       // between start/continue and stop
+static volatile bool midiRestart;       // next step is the first one
+static uint8_t midiPhase;               // clocks into the current step
+static volatile bool midiSeekPending;   // song position for midi_service
+static volatile uint16_t midiSeek;      // song position in 16th notes
+#endif
+#ifdef MIDI_JITTER
+static uint16_t midiEdge;               // start bit of the last clock
+static volatile uint16_t midiMin = 0xFFFF;
+static volatile uint16_t midiMax;
+static volatile uint32_t midiSum;
+static volatile uint8_t midiSteps;      // steps measured in this window
+#endif
+
+/* @NAME: midi_init
+ *
+ * @DESCRIPTION: Configures USART2 as a 31250 baud receiver on PF1 and
+ *               makes it the level 1 interrupt in place of the gate
+ *
+ * @NOTE: MUST run after AC0redge_init (and bench_init with MIDI_JITTER).
+ *        Does nothing unless MIDI_INPUT is defined
+ *
+ */
+void midi_init(void) {
+
+#ifdef MIDI_INPUT
+    PORTF.DIRCLR = PIN1_bm;
+    PORTF.PIN1CTRL |= PORT_PULLUPEN_bm;     // idle high with no cable
+    PORTMUX.USARTROUTEA = (PORTMUX.USARTROUTEA & ~PORTMUX_USART2_gm)
+            | PORTMUX_USART2_DEFAULT_gc;
+
+    USART2.BAUD = MIDI_BAUD;
+    USART2.CTRLC = USART_CMODE_ASYNCHRONOUS_gc | USART_CHSIZE_8BIT_gc
+            | USART_PMODE_DISABLED_gc | USART_SBMODE_1BIT_gc;
+    USART2.CTRLA = USART_RXCIE_bm;
+    USART2.CTRLB = USART_RXEN_bm;
+
+    // MIDI is the clock: the gate no longer steps
+    AC0.INTCTRL = 0;
+    CPUINT.LVL1VEC = USART2_RXC_vect_num;
+#endif
+
+#ifdef MIDI_JITTER
+    // every falling edge on RxD; 0xF8 has one, its start bit
+    EVSYS.CHANNEL5 = EVSYS_GENERATOR_PORT1_PIN1_gc;
+    EVSYS.USERTCB3 = EVSYS_CHANNEL_CHANNEL5_gc;
+
+    // capture mode free-runs over the full range like bench_init's setup
+    TCB3.CTRLA &= ~TCB_ENABLE_bm;
+    TCB3.CTRLB = TCB_CNTMODE_CAPT_gc;
+    TCB3.EVCTRL = TCB_CAPTEI_bm | TCB_EDGE_bm;
+    TCB3.CTRLA |= TCB_ENABLE_bm;
+#endif
+
+    return;
+
+}
+
+/* @NAME: midi_rx
+ *
+ * @DESCRIPTION: Parses one received byte; called from the USART2 ISR
+ *
+ * @PARAM:
+ *          c: the byte
+ *
+ * @NOTE: Returns MIDI_STEP (with MIDI_RESTART on the first step after a
+ *        start) when the byte is the clock a step falls on, else 0.
+ *        Constant cost: no loops, no divisions
+ *
+ */
+uint8_t midi_rx(uint8_t c) {
+
+#ifdef MIDI_INPUT
+    uint8_t tick = 0;
+
+    // real-time: anywhere, even inside a message; running status stays
+    if (c >= MIDI_CLOCK) {
+        switch (c) {
+            case MIDI_CLOCK:
+#ifdef MIDI_JITTER
+                midiEdge = TCB3.CCMP;
+#endif
+                if (!midiRunning || midiSeekPending) {
+                    break;
+                }
+                if (midiPhase == 0) {
+                    tick = MIDI_STEP;
+                    if (midiRestart) {
+                        tick |= MIDI_RESTART;
+                        midiRestart = false;
+                    }
+                }
+                midiPhase = (midiPhase + 1 < MIDI_CLOCKS_PER_STEP) ? midiPhase + 1 : 0;
+                break;
+            case MIDI_START:
+                midiRunning = true;
+                midiRestart = true;
+                midiPhase = 0;
+                break;
+            case MIDI_CONTINUE:
+                midiRunning = true;
+                break;
+            case MIDI_STOP:
+                midiRunning = false;
+                break;
+        }
+        return tick;
+    }
+
+    // status: channel messages set running status, system common clears it
+    if (c & 0x80) {
+        midiStatus = c;
+        midiCount = 0;
+        if (c < 0xC0 || (c >= 0xE0 && c < 0xF0)) {
+            midiNeed = 2;
+        } else if (c < 0xE0) {
+            midiNeed = 1;           // program change, channel pressure
+        } else if (c == MIDI_SONG_POSITION) {
+            midiNeed = 2;
+        } else if (c == 0xF1 || c == 0xF3) {
+            midiNeed = 1;           // time code, song select
+        } else {
+            midiNeed = 0;           // SysEx data and the rest are dropped
+            midiStatus = 0;
+        }
+        return 0;
+    }
+
+    // data
+    if (midiNeed == 0) {
+        return 0;
+    }
+    if (midiCount == 0 && midiNeed == 2) {
+        midiData = c;
+        midiCount = 1;
+        return 0;
+    }
+    midiCount = 0;
+
+    if (midiStatus == MIDI_SONG_POSITION) {
+        // 14 bits, LSB first; only moves a stopped sequencer
+        if (!midiRunning) {
+            midiSeek = midiData | ((uint16_t)c << 7);
+            // counted in 16ths, each a whole step
+            midiPhase = 0;
+            midiRestart = (midiSeek == 0);
+            midiSeekPending = (midiSeek != 0);
+        }
+    }
+
+    // system common has no running status
+    if (midiStatus >= 0xF0) {
+        midiNeed = 0;
+        midiStatus = 0;
+    }
+#else
+    (void)c;
+#endif
+
+    return 0;
+
+}
+
+/* @NAME: midi_stamp
+ *
+ * @DESCRIPTION: Records the start bit to DAC update time of a step; called
+ *               by the USART2 ISR after the step
+ *
+ * @NOTE: Does nothing unless MIDI_JITTER is defined
+ *
+ */
+void midi_stamp(void) {
+
+#ifdef MIDI_JITTER
+    uint16_t lat = TCB3.CNT - midiEdge;
+
+    if (lat < midiMin) {
+        midiMin = lat;
+    }
+    if (lat > midiMax) {
+        midiMax = lat;
+    }
+    midiSum += lat;
+    midiSteps++;
+#endif
+
+    return;
+
+}
+
+/* @NAME: midi_service
+ *
+ * @DESCRIPTION: Walks a stopped sequencer to a received song position;
+ *               called from the main loop
+ *
+ * @NOTE: Steps before the position count as played, so the next step
+ *        due is the one at it. Interrupts stay
+ *        on: clocks do not step until the walk is done
+ *
+ */
+void midi_service(void) {
+
+#ifdef MIDI_INPUT
+    uint16_t seek;
+
+    if (!midiSeekPending) {
+        return;
+    }
+
+    cli();
+    seek = midiSeek;
+    sei();
+
+    // a song position counts 16ths, i.e. steps
+    seekPattern(seek);
+    midiSeekPending = false;
+#endif
+
+    return;
+
+}
+
+/* @NAME: midi_pending
+ *
+ * @DESCRIPTION: Returns true while midi_service has a song position to walk
+ *               to
+ *
+ */
+bool midi_pending(void) {
+
+#ifdef MIDI_INPUT
+    return midiSeekPending;
+#else
+    return false;
+#endif
+
+}
+
+/* @NAME: midi_busy
+ *
+ * @DESCRIPTION: Returns true when the receiver needs the CPU clock, i.e.
+ *               in every MIDI_INPUT build; standby would lose bytes
+ *
+ */
+bool midi_busy(void) {
+
+#ifdef MIDI_INPUT
+    return true;
+#else
+    return false;
+#endif
+
+}
+
+/* @NAME: midi_report
+ *
+ * @DESCRIPTION: Prints the MIDI clock to DAC latency of the last
+ *               MIDI_JITTER_CLOCKS steps via USART3 (min, max, jitter and
+ *               mean); called from the main loop
+ *
+ */
+void midi_report(void) {
+
+#ifdef MIDI_JITTER
+    uint16_t min, max;
+    uint32_t sum;
+
+    if (midiSteps < MIDI_JITTER_CLOCKS) {
+        return;
+    }
+
+    cli();
+    min = midiMin;
+    max = midiMax;
+    sum = midiSum;
+    midiMin = 0xFFFF;
+    midiMax = 0;
+    midiSum = 0;
+    midiSteps = 0;
+    sei();
+
+    USART3_sendString("midi to dac min ");
+    USART3_sendWord(BENCH_TICKS_TO_US(min));
+    USART3_sendString("us max ");
+    USART3_sendWord(BENCH_TICKS_TO_US(max));
+    USART3_sendString("us jitter ");
+    USART3_sendWord(BENCH_TICKS_TO_US(max - min));
+    USART3_sendString("us mean ");
+    USART3_sendWord(BENCH_TICKS_TO_US(sum / MIDI_JITTER_CLOCKS));
+    USART3_sendString("us\n\r");
+#endif
+
+    return;
+
+}
@@ -0,0 +1,315 @@
+/*
+ * File:   player.c
+ * Author: N Mark
+ *
+ * Streaming playback of full-gate recordings from external flash.
+ *
+ * Each refill is one Fast Read burst of a page (128 samples) into the idle
+ * half of the buffer, so the sustainable sample rate is bounded by the SPI
+ * read time per page plus the DAC frame time per sample; play_benchmark()
+ * measures both on the target.
+ */
+
+#include "sequencer_utils.h"
+#include "player.h"
+
+/*
+ * local variables
+ */
+static uint16_t playBuf[2][REC_BUF_SAMPLES];   // double buffer fed to the DAC
+static volatile bool playReady[2];      // half is loaded
+static volatile uint8_t playLen[2];     // samples in each half
+static volatile uint8_t playHalf;       // half being read by play_tick
+static volatile uint8_t playIdx;        // next sample index in playHalf
+static volatile uint8_t playState = PLAY_IDLE;
+static volatile uint8_t playGen;        // bumped on every start/stop
+static volatile uint16_t playLeft;      // samples left to output
+static volatile uint16_t playUnderruns; // ticks with no loaded half
+static volatile uint8_t playNext;       // next half to load
+static volatile uint16_t playToRead;    // samples left to load
+static volatile uint32_t playAddr;      // next flash address to load from
+
+/* @NAME: play_start
+ *
+ * @DESCRIPTION: Starts streaming the given step's recording; called on the
+ *               gate edge in pattern playback mode
+ *
+ * @NOTE: Stops any stream still running for the previous step. Steps
+ *        without a recording leave the player idle. The sample count is
+ *        read from the slot header by play_service
+ *
+ */
+void play_start(uint8_t pattern, uint8_t step) {
+
+    play_stop();
+
+    if (!rec_recorded(pattern, step) || rec_busy()) {
+        return;
+    }
+
+    // play_service reads the slot header next; release the flash now
+    mem_wakeSoon();
+
+    playAddr = rec_slotAddr(pattern, step);
+    playToRead = 0;
+    playLeft = 0;
+
+    playReady[0] = false;
+    playReady[1] = false;
+    playHalf = 0;
+    playIdx = 0;
+    playNext = 0;
+
+    // tick is started by play_service once the first half is loaded
+    playState = PLAY_LOAD;
+
+    return;
+
+}
+
+/* @NAME: play_stop
+ *
+ * @DESCRIPTION: Stops the stream and releases the TCB2 tick
+ *
+ * @NOTE: Called from the gate ISR and from the main loop (mode button)
+ *
+ */
+void play_stop(void) {
+
+    uint8_t sreg = SREG;
+
+    cli();
+    if (playState != PLAY_IDLE) {
+        TCB2.CTRLA &= ~TCB_ENABLE_bm;
+        playState = PLAY_IDLE;
+    }
+
+    // invalidates any load in progress
+    playGen++;
+    SREG = sreg;
+
+    return;
+
+}
+
+/* @NAME: play_tick
+ *
+ * @DESCRIPTION: Sends one sample to the DAC; called from the TCB2 ISR
+ *
+ * @NOTE: When the next half is not loaded in time the last output is held
+ *        and the tick is counted as an underrun. The gate ISR may preempt
+ *        it and play_start/play_stop a stream; the sample is taken and the
+ *        position advanced with interrupts off, and a position whose
+ *        stream changed in between (playGen) is left alone
+ *
+ */
+void play_tick(void) {
+
+    uint16_t sample;
+    uint8_t gen;
+    uint8_t sreg = SREG;
+
+    cli();
+    if (playState != PLAY_RUN) {
+        SREG = sreg;
+        return;
+    }
+
+    if (!playReady[playHalf]) {
+        playUnderruns++;
+        SREG = sreg;
+        return;
+    }
+
+    sample = playBuf[playHalf][playIdx];
+    gen = playGen;
+    SREG = sreg;
+
+    sendDacCommand(sample);
+
+    cli();
+    if (gen != playGen) {
+        SREG = sreg;
+        return;
+    }
+
+    if (--playLeft == 0) {
+        TCB2.CTRLA &= ~TCB_ENABLE_bm;
+        playState = PLAY_IDLE;
+    } else if (++playIdx == playLen[playHalf]) {
+        playReady[playHalf] = false;
+        playHalf ^= 1;
+        playIdx = 0;
+    }
+    SREG = sreg;
+
+    return;
+
+}
+
+/* @NAME: play_service
+ *
+ * @DESCRIPTION: Loads the idle half with the next page of the recording;
+ *               called from the main loop
+ *
+ * @NOTE: A load that races with play_start/play_stop is discarded
+ *        (playGen changed); underruns are reported once the stream ends.
+ *        The first call of a stream only reads the slot header
+ *
+ */
+void play_service(void) {
+
+    uint8_t gen, half, n;
+    uint16_t toRead, len;
+    uint32_t addr;
+    bool ready;
+
+    cli();
+    gen = playGen;
+    half = playNext;
+    ready = playReady[half];
+    toRead = playToRead;
+    addr = playAddr;
+    sei();
+
+    if (playState == PLAY_IDLE) {
+        if (playUnderruns) {
+            USART3_sendString("play underrun ");
+            USART3_sendWord(playUnderruns);
+            USART3_sendString("\n\r");
+            cli();
+            playUnderruns = 0;
+            sei();
+        }
+        return;
+    }
+
+    // loading with nothing to read: sample count not known yet
+    if (playState == PLAY_LOAD && toRead == 0) {
+        mem_readInit(addr);
+        len = mem_readData() << 8;
+        len += mem_readData();
+        mem_readEnd();
+
+        cli();
+        if (gen == playGen) {
+            if (len == REC_EMPTY || len == 0) {
+                playState = PLAY_IDLE;
+            } else {
+                playToRead = len;
+                playLeft = len;
+                playAddr += MEM_PAGE_SIZE;
+            }
+        }
+        sei();
+        return;
+    }
+
+    if (ready || toRead == 0) {
+        return;
+    }
+
+    n = (toRead < REC_BUF_SAMPLES) ? toRead : REC_BUF_SAMPLES;
+
+    mem_fastReadInit(addr);
+    for (uint8_t i = 0; i < n; i++) {
+        playBuf[half][i] = mem_readData() << 8;
+        playBuf[half][i] += mem_readData();
+    }
+    mem_readEnd();
+
+    cli();
+    if (gen == playGen) {
+        playLen[half] = n;
+        playReady[half] = true;
+        playNext ^= 1;
+        playToRead -= n;
+        playAddr += 2 * n;
+
+        if (playState == PLAY_LOAD) {
+            playState = PLAY_RUN;
+            TCB2.CNT = 0;
+            TCB2.CTRLA |= TCB_ENABLE_bm;
+        }
+    }
+    sei();
+
+    return;
+
+}
+
+/* @NAME: play_busy
+ *
+ * @DESCRIPTION: Returns true while a stream is loading or running
+ *
+ */
+bool play_busy(void) {
+    return playState != PLAY_IDLE;
+}
+
+/* @NAME: play_pending
+ *
+ * @DESCRIPTION: Returns true while play_service has a half to load or
+ *               underruns to report
+ *
+ */
+bool play_pending(void) {
+
+    if (playState == PLAY_IDLE) {
+        return playUnderruns != 0;
+    }
+
+    // header still to read
+    if (playState == PLAY_LOAD && playToRead == 0) {
+        return true;
+    }
+
+    return !playReady[playNext] && playToRead != 0;
+
+}
+
+/* @NAME: play_benchmark
+ *
+ * @DESCRIPTION: Measures the Fast Read time of one page and the DAC time of
+ *               the same 128 samples, and prints the maximum sustainable
+ *               playback rate via USART3
+ *
+ * @NOTE: Drives the DAC with whatever is stored in the first slot;
+ *        MUST run before sei() with bench_init already done
+ *
+ */
+void play_benchmark(void) {
+
+    uint16_t t0, tRead, tDac;
+    uint32_t rate;
+    char buff[11] = {0};
+
+    t0 = bench_now();
+    mem_fastReadInit(MEM_REC_ADDR);
+    for (uint8_t i = 0; i < REC_BUF_SAMPLES; i++) {
+        playBuf[0][i] = mem_readData() << 8;
+        playBuf[0][i] += mem_readData();
+    }
+    mem_readEnd();
+    tRead = bench_now() - t0;
+
+    t0 = bench_now();
+    for (uint8_t i = 0; i < REC_BUF_SAMPLES; i++) {
+        sendDacCommand(playBuf[0][i]);
+    }
+    tDac = bench_now() - t0;
+
+    rate = (uint32_t)F_CPU * REC_BUF_SAMPLES / ((uint32_t)tRead + tDac);
+
+    USART3_sendString("play bench: read ");
+    USART3_sendWord(BENCH_TICKS_TO_US(tRead));
+    USART3_sendString("us/page, dac ");
+    USART3_sendWord(BENCH_TICKS_TO_US(tDac));
+    USART3_sendString("us/page, max ");
+    ultoa(rate, buff, 10);
+    USART3_sendString(buff);
+    USART3_sendString("Hz\n\r");
+
+    return;
+
+}
@@ -0,0 +1,191 @@
+/*
+ * File:   power.c
+ * Author: N Mark
+ *
+ * Sleep between events, and gate wake-up latency instrumentation.
+ *
+ * The latency is the time from the AC0 output edge to the first
+ * instruction of the AC0 ISR. TCB3 runs in standby while it is measured,
+ * which keeps the main oscillator on, so the standby figure excludes the
+ * oscillator start-up time (see the OSC20M start-up in the datasheet).
+ */
+
+#include <avr/sleep.h>
+#include "sequencer_utils.h"
+#include "power.h"
+
+/*
+ * local variables
+ */
+static volatile uint8_t pwrLevel = PWR_AWAKE;    // level the CPU sleeps in
+#ifdef PWR_LATENCY
+static volatile uint16_t pwrMax[PWR_LEVELS];     // worst latency per level (ticks)
+static uint16_t pwrReported[PWR_LEVELS];         // last maxima printed
+#endif
+
+/* @NAME: pwr_init
+ *
+ * @DESCRIPTION: Sets up the latency capture when PWR_LATENCY is defined
+ *
+ * @NOTE: MUST run after bench_init (TCB3 is the timestamp) and
+ *        AC0redge_init
+ *
+ */
+void pwr_init(void) {
+
+#ifdef PWR_LATENCY
+    EVSYS.CHANNEL0 = EVSYS_GENERATOR_AC0_OUT_gc;
+    EVSYS.USERTCB3 = EVSYS_CHANNEL_CHANNEL0_gc;
+
+    // capture mode free-runs over the full range like bench_init's setup
+    TCB3.CTRLA &= ~TCB_ENABLE_bm;
+    TCB3.CTRLB = TCB_CNTMODE_CAPT_gc;
+    TCB3.EVCTRL = TCB_CAPTEI_bm;        // rising edge
+    TCB3.CTRLA |= TCB_RUNSTDBY_bm | TCB_ENABLE_bm;
+#endif
+
+    return;
+
+}
+
+/* @NAME: pwr_scanNeeded
+ *
+ * @DESCRIPTION: Returns true while anything reads the ADC scan: the gate
+ *               ISR or the recorder samples the CV input, or the gate or
+ *               division pot is serviced
+ *
+ */
+static bool pwr_scanNeeded(void) {
+
+    return status.freeRun || status.recordEnable || status.gateRecord
+            || rec_busy() || gate_busy() || clock_busy();
+
+}
+
+/* @NAME: pwr_deepest
+ *
+ * @DESCRIPTION: Returns the deepest sleep level the current mode allows
+ *
+ */
+static uint8_t pwr_deepest(void) {
+
+    if (PWR_SLEEP_DEEPEST == PWR_IDLE) {
+        return PWR_IDLE;
+    }
+
+    // the ADC scan runs (standby would abort its conversion), the sample
+    // tick is running, a DAC frame is still shifting out of USART1 or
+    // MIDI is listening
+    if (pwr_scanNeeded() || play_busy() || dac_busy() || midi_busy()) {
+        return PWR_IDLE;
+    }
+
+    return PWR_STANDBY;
+
+}
+
+/* @NAME: pwr_sleep
+ *
+ * @DESCRIPTION: Sleeps until the next interrupt unless a service has work
+ *               pending; called at the end of every main loop pass
+ *
+ * @NOTE: Interrupts are off from the check until the sleep instruction
+ *        (the instruction after sei always executes), so an event posted
+ *        by an ISR in between still wakes the CPU at once. The ADC scan is
+ *        paused while nothing reads it, so its RESRDY chain neither wakes
+ *        the CPU in idle nor is cut by standby, and resumed once something
+ *        does
+ *
+ */
+void pwr_sleep(void) {
+
+    uint8_t level = pwr_deepest();
+
+    if (pwr_scanNeeded()) {
+        ADC0_scanResume();
+    } else {
+        ADC0_scanPause();
+    }
+
+    // flash stays in standby only while a stream is running
+    if (!rec_busy() && !play_busy()) {
+        mem_powerDown();
+    }
+
+    cli();
+    if (evt_pending() || song_pending() || rec_pending() || play_pending()
+            || mem_erasing() || trace_pending() || midi_pending()) {
+        sei();
+        return;
+    }
+
+    if (level == PWR_STANDBY) {
+        SLPCTRL.CTRLA = SLPCTRL_SMODE_STDBY_gc | SLPCTRL_SEN_bm;
+    } else {
+        SLPCTRL.CTRLA = SLPCTRL_SMODE_IDLE_gc | SLPCTRL_SEN_bm;
+    }
+    pwrLevel = level;
+
+    sei();
+    sleep_cpu();
+
+    // the ISR that woke the CPU has already run
+    pwrLevel = PWR_AWAKE;
+    SLPCTRL.CTRLA &= ~SLPCTRL_SEN_bm;
+
+    return;
+
+}
+
+/* @NAME: pwr_wakeStamp
+ *
+ * @DESCRIPTION: Records the gate wake-up latency; first statement of the
+ *               AC0 ISR when PWR_LATENCY is defined
+ *
+ */
+void pwr_wakeStamp(void) {
+
+#ifdef PWR_LATENCY
+    uint16_t lat = TCB3.CNT - TCB3.CCMP;
+    uint8_t level = pwrLevel;
+
+    if (lat > pwrMax[level]) {
+        pwrMax[level] = lat;
+    }
+#endif
+
+    return;
+
+}
+
+/* @NAME: pwr_report
+ *
+ * @DESCRIPTION: Prints any new worst-case wake-up latency via USART3;
+ *               called from the main loop
+ *
+ */
+void pwr_report(void) {
+
+#ifdef PWR_LATENCY
+    static const char *names[PWR_LEVELS] = {"awake", "idle", "standby"};
+    uint16_t max;
+
+    for (uint8_t level = 0; level < PWR_LEVELS; level++) {
+        cli();
+        max = pwrMax[level];
+        sei();
+
+        if (max != pwrReported[level]) {
+            pwrReported[level] = max;
+            USART3_sendString("wake ");
+            USART3_sendString((char *)names[level]);
+            USART3_sendString(" max ");
+            USART3_sendWord(BENCH_TICKS_TO_US(max));
+            USART3_sendString("us\n\r");
+        }
+    }
+#endif
+
+    return;
+
+}
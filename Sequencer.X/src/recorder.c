@@ -0,0 +1,354 @@
+/*
+ * File:   recorder.c
+ * Author: N Mark
+ *
+ * Full-gate CV recording into external flash.
+ *
+ * Timing at the default REC_SAMPLE_RATE: a ring half (128 samples) spans
+ * 128ms, while programming it takes ~1.3ms of SPI shifting plus tPP (3ms max),
+ * and the 4KB sector erase done every 16 pages takes tSE (45ms typ). The
+ * writer keeps up with room to spare; when it does fall behind, the tick
+ * drops samples rather than overwrite an unwritten half and the drop count
+ * is reported when the recording ends.
+ */
+
+#include "sequencer_utils.h"
+#include "recorder.h"
+
+/*
+ * local variables
+ */
+static uint16_t recBuf[2][REC_BUF_SAMPLES]; // double-buffered sample ring
+static volatile bool recPending[2];     // half is full, waiting for its page program
+static volatile uint8_t recFill;        // half being filled by rec_tick
+static volatile uint8_t recIdx;         // next sample index in recFill
+static volatile uint8_t recState = REC_IDLE;
+static volatile uint16_t recCount;      // samples captured
+static volatile uint16_t recOverruns;   // samples dropped by a full ring
+static uint8_t recWrite;                // next half to program
+static bool recErased;                  // first sector of the slot erased
+static uint32_t recSlot;                // slot of the recording step
+static uint32_t recAddr;                // next page to program
+static uint8_t recPattern;              // pattern and step that own the recording
+static uint8_t recStep;
+static uint8_t recHas[NUM_PATTERNS][NUM_PAGES];    // bitmap of slots with a recording
+static uint32_t recSlotSize;            // bytes per step, set by rec_init
+static uint16_t recMaxSamples;          // samples that fit in a slot
+
+/* @NAME: rec_init
+ *
+ * @DESCRIPTION: Configures TCB2 as the REC_SAMPLE_RATE sample tick, sizes
+ *               the slots to the flash and marks every slot holding a
+ *               recording
+ *
+ * @NOTE: Timer is only enabled while a recording (or playback) is running.
+ *        MUST run after mem_init. Recording is disabled (no slots) on a
+ *        read only part or one too small for a sector per step above
+ *        MEM_REC_ADDR
+ *
+ */
+void rec_init(void) {
+
+    uint16_t len;
+    uint32_t slot = 0;
+
+    // sector aligned share of everything above MEM_REC_ADDR
+    if (mem_writable() && mem_geometry()->size > MEM_REC_ADDR) {
+        slot = (mem_geometry()->size - MEM_REC_ADDR) / (NUM_PATTERNS * NUM_STEPS);
+    }
+    if (slot > REC_SLOT_MAX) {
+        slot = REC_SLOT_MAX;
+    }
+    recSlotSize = slot & ~(uint32_t)(MEM_SECTOR_SIZE - 1);
+    recMaxSamples = recSlotSize ? (recSlotSize - MEM_PAGE_SIZE) / 2 : 0;
+
+    TCB2.CCMP = (F_CPU / REC_SAMPLE_RATE) - 1;
+    TCB2.CTRLB = TCB_CNTMODE_INT_gc;        // periodic interrupt mode
+    TCB2.INTCTRL = TCB_CAPT_bm;
+    TCB2.CTRLA = TCB_CLKSEL_CLKDIV1_gc;     // CLK_PER, disabled
+
+    if (!recSlotSize) {
+        USART3_sendString("recording disabled\n\r");
+        return;
+    }
+
+    for (uint8_t pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        for (uint8_t sidx = 0; sidx < NUM_STEPS; sidx++) {
+            mem_readInit(rec_slotAddr(pidx, sidx));
+            len = mem_readData() << 8;
+            len += mem_readData();
+            mem_readEnd();
+
+            if (len != REC_EMPTY && len != 0) {
+                recHas[pidx][STEP_PAGE(sidx)] |= STEP_BIT(sidx);
+            }
+        }
+    }
+
+    return;
+
+}
+
+/* @NAME: rec_recorded
+ *
+ * @DESCRIPTION: Returns true if a step's slot holds a complete recording
+ *
+ * @NOTE: One bit per step; the sample count stays in the slot header
+ *
+ */
+bool rec_recorded(uint8_t pattern, uint8_t step) {
+    return recHas[pattern][STEP_PAGE(step)] & STEP_BIT(step);
+}
+
+/* @NAME: rec_patternRecorded
+ *
+ * @DESCRIPTION: Returns true if any step of a pattern has a recording
+ *
+ */
+bool rec_patternRecorded(uint8_t pattern) {
+
+    for (uint8_t page = 0; page < NUM_PAGES; page++) {
+        if (recHas[pattern][page]) {
+            return true;
+        }
+    }
+
+    return false;
+
+}
+
+/* @NAME: rec_busy
+ *
+ * @DESCRIPTION: Returns true while a recording is running or flushing
+ *
+ */
+bool rec_busy(void) {
+    return recState != REC_IDLE;
+}
+
+/* @NAME: rec_pending
+ *
+ * @DESCRIPTION: Returns true while rec_service has flash work to do
+ *
+ */
+bool rec_pending(void) {
+    return recState == REC_STOP
+            || (recState == REC_RUN && (!recErased || recPending[recWrite]));
+}
+
+/* @NAME: rec_slotAddr
+ *
+ * @DESCRIPTION: Returns the flash address of a step's recording slot
+ *
+ * @PARAM:
+ *          pattern: pattern index
+ *          step:    step index
+ *
+ */
+uint32_t rec_slotAddr(uint8_t pattern, uint8_t step) {
+    return MEM_REC_ADDR + (uint32_t)(pattern * NUM_STEPS + step) * recSlotSize;
+}
+
+/* @NAME: rec_start
+ *
+ * @DESCRIPTION: Starts a full-gate recording into the given step's slot;
+ *               called on the rising gate edge
+ *
+ * @NOTE: A gate arriving while the previous recording is still flushing
+ *        is counted as an overrun. Nothing is recorded while rec_clear's
+ *        erase is running, it would wipe the recording again, nor when
+ *        rec_init disabled recording
+ *
+ */
+void rec_start(uint8_t pattern, uint8_t step) {
+
+    if (!recSlotSize) {
+        return;
+    }
+
+    if (recState != REC_IDLE) {
+        recOverruns++;
+        return;
+    }
+
+    if (mem_erasing()) {
+        return;
+    }
+
+    // recorder and player share the TCB2 tick
+    play_stop();
+
+    // slot is rewritten; not playable until the recording is complete
+    recPattern = pattern;
+    recStep = step;
+    recHas[pattern][STEP_PAGE(step)] &= ~STEP_BIT(step);
+
+    recSlot = rec_slotAddr(pattern, step);
+    recAddr = recSlot + MEM_PAGE_SIZE;
+    recErased = false;
+
+    recPending[0] = false;
+    recPending[1] = false;
+    recFill = 0;
+    recIdx = 0;
+    recWrite = 0;
+    recCount = 0;
+    recOverruns = 0;
+
+    recState = REC_RUN;
+
+    // rec_service erases the slot next; release the flash now
+    mem_wakeSoon();
+
+    TCB2.CNT = 0;
+    TCB2.CTRLA |= TCB_ENABLE_bm;
+
+    return;
+
+}
+
+/* @NAME: rec_tick
+ *
+ * @DESCRIPTION: Captures one sample into the ring; called from the TCB2 ISR
+ *
+ * @NOTE: Stops the recording once the gate is low or the slot is full
+ *
+ */
+void rec_tick(void) {
+
+    uint16_t sample;
+    bool gate;
+
+    if (recState != REC_RUN) {
+        return;
+    }
+
+    gate = AC0.STATUS & AC_STATE_bm;
+    if (!gate) {
+        TRACE_EVENT(TRACE_GATE, 0);
+    }
+
+    if (!gate || recCount == recMaxSamples) {
+        TCB2.CTRLA &= ~TCB_ENABLE_bm;
+        recState = REC_STOP;
+        return;
+    }
+
+    sample = oneShotSample();
+    sendDacCommand(sample);
+
+    // writer still busy with this half
+    if (recPending[recFill]) {
+        recOverruns++;
+        return;
+    }
+
+    recBuf[recFill][recIdx] = sample;
+    recCount++;
+
+    if (++recIdx == REC_BUF_SAMPLES) {
+        recPending[recFill] = true;
+        recFill ^= 1;
+        recIdx = 0;
+    }
+
+    return;
+
+}
+
+/* @NAME: rec_writePage
+ *
+ * @DESCRIPTION: Programs n samples as the next page of the slot, erasing
+ *               each sector on its first page
+ *
+ */
+static void rec_writePage(uint16_t *buf, uint8_t n) {
+
+    if ((recAddr & (MEM_SECTOR_SIZE - 1)) == 0) {
+        mem_sectorErase(recAddr);
+    }
+
+    mem_pageProgramInit(recAddr);
+    for (uint8_t i = 0; i < n; i++) {
+        mem_pageProgramData(buf[i] >> 8);
+        mem_pageProgramData(buf[i] & 0xFF);
+    }
+    mem_pageProgramEnd();
+
+    recAddr += MEM_PAGE_SIZE;
+
+}
+
+/* @NAME: rec_service
+ *
+ * @DESCRIPTION: Drains the sample ring into flash; called from the main loop
+ *
+ * @NOTE: On the end of a recording the last partial half is flushed, the
+ *        sample count is written to the slot header and the result
+ *        (and any overrun) is reported via USART3
+ *
+ */
+void rec_service(void) {
+
+    if (recState == REC_IDLE) {
+        return;
+    }
+
+    // header sector is erased up front; later sectors by rec_writePage
+    if (!recErased) {
+        mem_sectorErase(recSlot);
+        recErased = true;
+    }
+
+    if (recPending[recWrite]) {
+        rec_writePage(recBuf[recWrite], REC_BUF_SAMPLES);
+        recPending[recWrite] = false;
+        recWrite ^= 1;
+    } else if (recState == REC_STOP) {
+        // tick is stopped, recFill and recIdx no longer change
+        if (recIdx) {
+            rec_writePage(recBuf[recFill], recIdx);
+        }
+
+        mem_pageProgramWord(recSlot, recCount);
+        if (recCount) {
+            recHas[recPattern][STEP_PAGE(recStep)] |= STEP_BIT(recStep);
+        }
+
+        USART3_sendString("rec ");
+        USART3_sendWord(recCount);
+        if (recOverruns) {
+            USART3_sendString(" overrun ");
+            USART3_sendWord(recOverruns);
+        }
+        USART3_sendString("\n\r");
+
+        recState = REC_IDLE;
+    }
+
+    return;
+
+}
+
+/* @NAME: rec_clear
+ *
+ * @DESCRIPTION: Deletes every recording; the slots are erased in the
+ *               background by mem_eraseService
+ *
+ * @NOTE: Only the slots in use are erased, 64KB blocks where they line
+ *        up; no slot is playable from here on
+ *
+ */
+void rec_clear(void) {
+
+    for (uint8_t pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        for (uint8_t page = 0; page < NUM_PAGES; page++) {
+            recHas[pidx][page] = 0;
+        }
+    }
+
+    mem_eraseStart(MEM_REC_ADDR, recSlotSize * NUM_PATTERNS * NUM_STEPS);
+
+    return;
+
+}
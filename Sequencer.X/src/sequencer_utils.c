@@ -14,6 +14,23 @@ volatile uint8_t dacCommandH; // d8-d15 of data to the DAC
 volatile uint8_t dacCommandL; // d0-d7 of data to the DAC
 volatile uint8_t rotaryPrevPos = 0;  // tracks previous position of the encoder
 volatile uint8_t rotaryPos;
+static step_pattern_t patternBuf[2];    // live and shadow copy of the current pattern
+static step_pattern_t * volatile shadowPattern; // copy being prepared by publishPattern
+static volatile bool shadowPending;     // shadow is complete, swap at next step
+static volatile bool shadowHeld;        // staged by song mode, swap on release
+static step_order_t orderBuf[2];        // play orders of the live and shadow pattern
+static step_order_t *currOrder;         // play order of currPattern
+static step_order_t * volatile shadowOrder;
+static uint8_t playPos;                 // position in currOrder
+static uint8_t repeatLeft;              // repeats left on the current step
+static bool playHeld;                   // playback button held, as of the last
+                                        // EVT_PLAYBACK_BUTTON
+static bool pageTurned;                 // encoder turned the page while the
+                                        // playback button was held
+static uint16_t rngState = 0xACE1;      // xorshift state for the random modes
+static uint8_t contextCopy;             // context copy (0: A, 1: B) saved last
+static uint16_t contextSeq;             // its sequence number
+static uint8_t editStepIdx;             // step last touched by toggleSteps
 
 /* @NAME: io_init
  * 
@@ -53,16 +70,20 @@ void io_init(void) {
     PORTB.DIR |= PIN3_bm;
     PORTB.OUTCLR = PIN3_bm;
     
-    // Playback mode button on PD4
+    // Playback mode button on PD4; both edges, held for page select
     // INTERRUPT on PORTD
-    PORTD.PIN4CTRL |= PORT_ISC_FALLING_gc | PORT_PULLUPEN_bm;
+    PORTD.PIN4CTRL |= PORT_ISC_BOTHEDGES_gc | PORT_PULLUPEN_bm;
     
     //Program mode LED on PB2
     PORTB.DIR |= PIN2_bm;
     PORTB.OUTCLR = PIN2_bm;
     
-    // saveContext button on PC0
+    // saveContext button on PC0 (PC1 with DAC_USART, PC0 is TxD)
+#ifdef DAC_USART
+    PORTC.PIN1CTRL |= PORT_ISC_FALLING_gc | PORT_PULLUPEN_bm;
+#else
     PORTC.PIN0CTRL |= PORT_ISC_FALLING_gc | PORT_PULLUPEN_bm;
+#endif
     
     return;
     
@@ -104,30 +125,37 @@ void rtc_pit_init(void) {
 void sequencer_init(void) {
     
     // initialize all patterns w/ 0th step, steps enabled, empty value,
-    // repeat and counter at 0
-    for (uint8_t i = 0; i < 8; i++) {
-        for (uint8_t j = 0; j < 8; j++) {
-            patterns[i].steps[j].enable = true;
+    // repeat at 0, default gate
+    for (uint8_t i = 0; i < NUM_PATTERNS; i++) {
+        for (uint8_t j = 0; j < NUM_STEPS; j++) {
             patterns[i].steps[j].value = 0;
             patterns[i].steps[j].repeat = 0;
-            patterns[i].steps[j].counter = 0;
+            patterns[i].steps[j].gate = GATE_DEFAULT;
         }
-        // set all sequence lengths to 8
-        patterns[i].seqLength = 8;
+        for (uint8_t j = 0; j < NUM_PAGES; j++) {
+            patterns[i].enable[j] = 0xFF;
+        }
+        // set all sequence lengths to NUM_STEPS
+        patterns[i].seqLength = NUM_STEPS;
         // set initial pattern to 0th
         patterns[i].idx = i;
+        // step on every gate
+        patterns[i].clockDiv = 1;
     }
     
     // initialize sequencer status struct
     status.currPatternIdx = 0;
     status.currStepIdx = 0;
     status.freeRun = true;
+    status.songMode = false;
     status.patternMode = 0;
     status.recordEnable = false;
+    status.gateRecord = false;
+    status.page = 0;
     status.saved = false;
     
     // set initial current pattern to 0th
-    currPattern = &patterns[0];
+    loadPattern();
     
     return;
     
@@ -137,274 +165,490 @@ void sequencer_init(void) {
  * 
  * @DESCRIPTION: step buttons toggle steps on/off and adjust a step's repeat attribute 
  *               
- * @NOTE: 
+ * @PARAM: 
+ *          buttons: pressed step buttons (~PORTA.IN) captured by the PORTA ISR
+ * 
+ * @NOTE: runs from the main loop (EVT_STEP_BUTTONS); the change is played
+ *        from the next step on. Buttons act on the steps of status.page; 
+ *        the edit is one enable byte and one step whatever NUM_STEPS is
  * 
  */
-void toggleSteps(void) {
+void toggleSteps(uint8_t buttons) {
+    
+    // edits go to the pattern store, the gate ISR plays a published copy
+    step_pattern_t *editPattern = &patterns[status.currPatternIdx];
+    uint8_t *enable = &editPattern->enable[status.page];
+    step_t *editStep;
+    uint8_t sidx = status.page * PAGE_STEPS;
+    
+    // buttons is a bitmap for the step buttons of the page;
+    // one button at a time
+    if (buttons == 0 || (buttons & (buttons - 1))) {
+        return;
+    }
     
-    // ~PORTA.IN&0xFF is a bitmap for the step buttons
-    // cases are 2^n but simply map to steps n = 0-7
-    switch (~PORTA.IN&0xFF) {
-        
-        case 1: 
-            if (currPattern->steps[0].enable) {
-                   // if step's enabled, add a step repeat 
-                   if(currPattern->steps[0].repeat < 2){
-                        currPattern->steps[0].repeat++;
-                        currPattern->steps[0].counter++;
-                        currPattern->seqLength++;
-                    } 
-                   // else no step repeats
-                   else {
-                       currPattern->steps[0].enable = false;
-                       currPattern->steps[0].repeat = 0;
-                       currPattern->steps[0].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
-            }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[0].enable = true;
-                currPattern->seqLength++;   
-            }        
-            break;
-            
-        case 2:
-            if (currPattern->steps[1].enable) {
-                    //if enabled and repeat = 0 ; repeat = 1 
-                   if(currPattern->steps[1].repeat < 2){
-                        currPattern->steps[1].repeat++;
-                        currPattern->steps[1].counter++;
-                        currPattern->seqLength++;
-                    }  
-                    //if enabled and repeat = 1 ; repeat = 2
-                   else {
-                       currPattern->steps[1].enable = false;
-                       currPattern->steps[1].repeat = 0;
-                       currPattern->steps[1].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
-            }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[1].enable = true;
-                currPattern->seqLength++;   
-            }
-            break;
-            
-        case 4:
-            if (currPattern->steps[2].enable) {
-                    //if enabled and repeat = 0 ; repeat = 1 
-                   if(currPattern->steps[2].repeat < 2){
-                        currPattern->steps[2].repeat++;
-                        currPattern->steps[2].counter++;
-                        currPattern->seqLength++;
-                    } else {
-                       currPattern->steps[2].enable = false;
-                       currPattern->steps[2].repeat = 0;
-                       currPattern->steps[2].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
-            }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[2].enable = true;
-                currPattern->seqLength++;   
-            }
-            break;
-            
-        case 8:
-            if (currPattern->steps[3].enable) {
-                    //if enabled and repeat = 0 ; repeat = 1 
-                   if(currPattern->steps[3].repeat < 2){
-                        currPattern->steps[3].repeat++;
-                        currPattern->steps[3].counter++;
-                        currPattern->seqLength++;
-                    } else {
-                       currPattern->steps[3].enable = false;
-                       currPattern->steps[3].repeat = 0;
-                       currPattern->steps[3].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
+    for (uint8_t bit = buttons; bit > 1; bit >>= 1) {
+        sidx++;
+    }
+    editStep = &editPattern->steps[sidx];
+    editStepIdx = sidx;
+    
+    if (*enable & buttons) {
+        // if step's enabled, add a step repeat 
+        if (editStep->repeat < 2) {
+            editStep->repeat++;
+            editPattern->seqLength++;
+        } 
+        // else no step repeats
+        else {
+            *enable &= ~buttons;
+            editStep->repeat = 0;
+            editPattern->seqLength -= 2;
+        }
+    }
+    //if disabled ;  enable 
+    else {
+        *enable |= buttons;
+        editPattern->seqLength++;   
+    }
+    
+    publishPattern();
+    
+    return;
+
+}
+
+/* @NAME: setStepGate
+ * 
+ * @DESCRIPTION: Sets the gate length of the step last touched with a step 
+ *               button (gate pot, see gate.h)
+ *               
+ * @PARAM: 
+ *          gate: % of the clock period, GATE_MIN to GATE_MAX
+ * 
+ * @NOTE: main loop only; played from the next step on like toggleSteps
+ * 
+ */
+void setStepGate(uint8_t gate) {
+    
+    step_t *editStep = &patterns[status.currPatternIdx].steps[editStepIdx];
+    
+    if (editStep->gate == gate) {
+        return;
+    }
+    editStep->gate = gate;
+    
+    publishPattern();
+    
+    return;
+
+}
+
+/* @NAME: setClockDiv
+ * 
+ * @DESCRIPTION: Sets the clock division of the current pattern (division 
+ *               pot, see clock.h)
+ *               
+ * @PARAM: 
+ *          div: gate edges per step, 1 to CLOCK_DIV_MAX
+ * 
+ * @NOTE: main loop only; the gate ISR switches to it with the published 
+ *        pattern
+ * 
+ */
+void setClockDiv(uint8_t div) {
+    
+    step_pattern_t *editPattern = &patterns[status.currPatternIdx];
+    
+    if (editPattern->clockDiv == div) {
+        return;
+    }
+    editPattern->clockDiv = div;
+    
+    publishPattern();
+    
+    return;
+
+}
+
+/* @NAME: publishPattern
+ * 
+ * @DESCRIPTION: Copies the current pattern from the pattern store into the 
+ *               shadow buffer and marks it for the gate ISR to swap in at 
+ *               the next step boundary
+ *               
+ * @NOTE: main loop only. While song mode holds the next entry in the 
+ *        shadow, edits stay in the pattern store and play on the pattern's 
+ *        next turn
+ * 
+ */
+void publishPattern(void) {
+    
+    if (shadowHeld) {
+        return;
+    }
+    
+    stagePattern(status.currPatternIdx, false);
+    
+    return;
+    
+}
+
+/* @NAME: stagePattern
+ * 
+ * @DESCRIPTION: Copies a pattern from the pattern store into the shadow 
+ *               buffer and marks it complete
+ *               
+ * @PARAM: 
+ *          pidx: pattern to stage
+ *          hold: if true, the ISR swaps it in only after releasePattern
+ * 
+ * @NOTE: main loop only. A shadow that was staged but not swapped in 
+ *        yet is simply taken back and refreshed; the ISR only ever swaps 
+ *        a complete copy
+ * 
+ */
+void stagePattern(uint8_t pidx, bool hold) {
+    
+    step_pattern_t *src = &patterns[pidx];
+    uint8_t sreg;
+    
+    // the ISR never runs in the middle of this, so no swap can follow it
+    shadowPending = false;
+    shadowHeld = hold;
+    
+    for (uint8_t sidx = 0; sidx < NUM_STEPS; sidx++) {
+        // value may be written by the gate ISR (recordSample)
+        sreg = SREG;
+        cli();
+        shadowPattern->steps[sidx] = src->steps[sidx];
+        SREG = sreg;
+    }
+    for (uint8_t page = 0; page < NUM_PAGES; page++) {
+        shadowPattern->enable[page] = src->enable[page];
+    }
+    shadowPattern->seqLength = src->seqLength;
+    shadowPattern->idx = src->idx;
+    shadowPattern->clockDiv = src->clockDiv;
+    
+    // all the per-mode work happens here, not on the gate
+    buildOrder(shadowPattern, status.patternMode, shadowOrder);
+    
+    shadowPending = true;
+    
+    return;
+    
+}
+
+/* @NAME: swapPattern
+ * 
+ * @DESCRIPTION: Makes a published shadow the live pattern; called by the 
+ *               gate ISR at the step boundary
+ *               
+ * @NOTE: the repeat countdown carries over, clamped to the new repeat 
+ *        count; constant cost whatever NUM_STEPS is
+ * 
+ */
+void swapPattern(void) {
+    
+    step_pattern_t *old = currPattern;
+    step_order_t *oldOrder = currOrder;
+    
+    if (!shadowPending || shadowHeld) {
+        return;
+    }
+    
+    currPattern = shadowPattern;
+    shadowPattern = old;
+    currOrder = shadowOrder;
+    shadowOrder = oldOrder;
+    shadowPending = false;
+    
+    if (playPos >= currOrder->len) {
+        playPos = 0;
+    }
+    
+    if (currPattern->idx != old->idx
+            || repeatLeft > currPattern->steps[status.currStepIdx].repeat) {
+        repeatLeft = currPattern->steps[status.currStepIdx].repeat;
+    }
+    
+    return;
+    
+}
+
+/* @NAME: releasePattern
+ * 
+ * @DESCRIPTION: Lets a held shadow be swapped in; called by the gate ISR 
+ *               on a song boundary
+ *               
+ * @NOTE: Returns false if nothing complete is held
+ * 
+ */
+bool releasePattern(void) {
+    
+    if (!shadowPending || !shadowHeld) {
+        return false;
+    }
+    
+    shadowHeld = false;
+    
+    return true;
+    
+}
+
+/* @NAME: restartPattern
+ * 
+ * @DESCRIPTION: Starts the live pattern from its first step; called by the 
+ *               gate ISR in place of step() on a song boundary
+ *               
+ * @NOTE: the first step's repeat countdown starts over. Returns step()'s 
+ *        result, false if the first entry is a Euclidean rest
+ * 
+ */
+bool restartPattern(void) {
+    
+    // position just before the first entry, with its countdown done
+    playPos = currOrder->len ? currOrder->len - 1 : 0;
+    repeatLeft = 0;
+    
+    return step();
+    
+}
+
+/* @NAME: orderGates
+ * 
+ * @DESCRIPTION: Returns the number of gates one pass through a play order 
+ *               takes, repeats included; at least 1
+ * 
+ */
+static uint16_t orderGates(const step_pattern_t *pat, const step_order_t *order) {
+    
+    uint16_t gates = 0;
+    
+    for (uint8_t i = 0; i < order->len; i++) {
+        if (order->idx[i] == STEP_REST) {
+            gates++;
+        } else {
+            gates += pat->steps[order->idx[i]].repeat + 1;
+        }
+    }
+    
+    return gates ? gates : 1;
+    
+}
+
+/* @NAME: seekPattern
+ * 
+ * @DESCRIPTION: Positions the playback as if the given number of gates had
+ *               been played since restartPattern
+ *               
+ * @PARAM: 
+ *          gates: gates played, at least 1 (1 is restartPattern itself)
+ * 
+ * @NOTE: Taken modulo the live order's pass, so it costs at most one pass 
+ *        of step() calls. MIDI song position only: nothing else may step 
+ *        meanwhile
+ * 
+ */
+void seekPattern(uint16_t gates) {
+    
+    gates = (gates - 1) % orderGates(currPattern, currOrder);
+    
+    restartPattern();
+    while (gates--) {
+        step();
+    }
+    
+    return;
+    
+}
+
+/* @NAME: loadPattern
+ * 
+ * @DESCRIPTION: Publishes the current pattern and makes it live at once
+ *               
+ * @NOTE: boot only (interrupts disabled)
+ * 
+ */
+void loadPattern(void) {
+    
+    currPattern = &patternBuf[0];
+    shadowPattern = &patternBuf[1];
+    currOrder = &orderBuf[0];
+    shadowOrder = &orderBuf[1];
+    playPos = 0;
+    
+    publishPattern();
+    swapPattern();
+    
+    return;
+    
+}
+
+/* @NAME: buildOrder
+ * 
+ * @DESCRIPTION: Precomputes the play order of a pattern for a playback mode, 
+ *               so step() costs the same in every mode
+ *               
+ * @PARAM: 
+ *          pat:   pattern to traverse
+ *          mode:  STEP_MODE_* playback mode
+ *          order: play order to fill
+ * 
+ * @NOTE: disabled steps never appear in the order. Random modes pick from 
+ *        the enabled steps; Euclidean spreads them evenly over NUM_STEPS 
+ *        gates, with STEP_REST on the gates in between
+ * 
+ */
+void buildOrder(step_pattern_t *pat, uint8_t mode, step_order_t *order) {
+    
+    uint8_t enabled[NUM_STEPS];
+    uint8_t n = 0;
+    uint8_t hit = 0;
+    
+    // empty pages cost one test
+    for (uint8_t page = 0; page < NUM_PAGES; page++) {
+        uint8_t sidx = page * PAGE_STEPS;
+        for (uint8_t bits = pat->enable[page]; bits; bits >>= 1, sidx++) {
+            if (bits & 0x01) {
+                enabled[n++] = sidx;
             }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[3].enable = true;
-                currPattern->seqLength++;   
+        }
+    }
+    
+    order->mode = mode;
+    order->len = 0;
+    
+    switch (mode) {
+        case STEP_MODE_BACKWARD:
+            for (uint8_t i = n; i > 0; i--) {
+                order->idx[order->len++] = enabled[i - 1];
             }
             break;
             
-        case 16:
-            if (currPattern->steps[4].enable) {
-                    //if enabled and repeat = 0 ; repeat = 1 
-                   if(currPattern->steps[4].repeat < 2){
-                        currPattern->steps[4].repeat++;
-                        currPattern->steps[4].counter++;
-                        currPattern->seqLength++;
-                    }  
-                    //if enabled and repeat = 1 ; repeat = 2
-                   else {
-                       currPattern->steps[4].enable = false;
-                       currPattern->steps[4].repeat = 0;
-                       currPattern->steps[4].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
+        case STEP_MODE_PINGPONG:
+            // ends are played once per turn
+            for (uint8_t i = 0; i < n; i++) {
+                order->idx[order->len++] = enabled[i];
             }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[4].enable = true;
-                currPattern->seqLength++;   
+            for (uint8_t i = n - 1; i > 1 && n > 2; i--) {
+                order->idx[order->len++] = enabled[i - 1];
             }
             break;
             
-        case 32:
-            if (currPattern->steps[5].enable) {
-                    //if enabled and repeat < 3 ; repeat++ 
-                   if(currPattern->steps[5].repeat < 2){
-                        currPattern->steps[5].repeat++;
-                        currPattern->steps[5].counter++;
-                        currPattern->seqLength++;
-                    } else {
-                       currPattern->steps[5].enable = false;
-                       currPattern->steps[5].repeat = 0;
-                       currPattern->steps[5].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
-            }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[5].enable = true;
-                currPattern->seqLength++;   
+        case STEP_MODE_EUCLID:
+            // E(n, NUM_STEPS): gate i is a hit when (i * n) mod NUM_STEPS < n
+            for (uint8_t i = 0; i < NUM_STEPS && n; i++) {
+                if ((i * n) % NUM_STEPS < n) {
+                    order->idx[order->len++] = enabled[hit++];
+                } else {
+                    order->idx[order->len++] = STEP_REST;
+                }
             }
             break;
             
-        case 64:
-            if (currPattern->steps[6].enable) {
-                    //if enabled and repeat < 3 ; repeat++ 
-                   if(currPattern->steps[6].repeat < 2){
-                        currPattern->steps[6].repeat++;
-                        currPattern->steps[6].counter++;
-                        currPattern->seqLength++;
-                    } else {
-                       currPattern->steps[6].enable = false;
-                       currPattern->steps[6].repeat = 0;
-                       currPattern->steps[6].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
-            }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[6].enable = true;
-                currPattern->seqLength++;   
+        default:
+            // forward, and the pool the random modes pick from
+            for (uint8_t i = 0; i < n; i++) {
+                order->idx[order->len++] = enabled[i];
             }
             break;
-            
-        case 128:
-            if (currPattern->steps[7].enable) {
-                    //if enabled and repeat < 3 ; repeat++ 
-                   if(currPattern->steps[7].repeat < 2){
-                        currPattern->steps[7].repeat++;
-                        currPattern->steps[7].counter++;
-                        currPattern->seqLength++;
-                    } else {
-                       currPattern->steps[7].enable = false;
-                       currPattern->steps[7].repeat = 0;
-                       currPattern->steps[7].counter = 0;
-                       currPattern->seqLength -= 2;
-                   }
-            }
-            //if disabled ;  enable 
-            else {
-                currPattern->steps[7].enable = true;
-                currPattern->seqLength++;   
-            }
-            break;                        
-      
-    }      
+    }
     
     return;
+    
+}
 
+/* @NAME: passGates
+ * 
+ * @DESCRIPTION: Returns the number of gates one pass through a pattern 
+ *               takes in the current playback mode, repeats included
+ * 
+ */
+uint16_t passGates(uint8_t pidx) {
+    
+    step_order_t order;
+    
+    buildOrder(&patterns[pidx], status.patternMode, &order);
+    
+    return orderGates(&patterns[pidx], &order);
+    
+}
+
+/* @NAME: nextRandom
+ * 
+ * @DESCRIPTION: 16-bit xorshift (7, 9, 8); period 65535, constant cost
+ * 
+ */
+static uint8_t nextRandom(void) {
+    
+    rngState ^= rngState << 7;
+    rngState ^= rngState >> 9;
+    rngState ^= rngState << 8;
+    
+    return rngState & 0xFF;
+    
 }
 
 /* @NAME: step
  * 
- * @DESCRIPTION: Steps through each pattern according to patternMode;  
+ * @DESCRIPTION: Steps through each pattern according to its play order;  
  *               called on rising gate/clock edge (see analog comparator ISR)
  *               
- * @NOTE: includes lighting of step LEDs
- *        ALSO, note recursive call below; this is what causes steps to 
- *        be skipped when they are disabled
+ * @NOTE: includes lighting of step LEDs. Returns false on a Euclidean rest, 
+ *        where the current step keeps sounding. Every mode is a handful of 
+ *        loads whatever NUM_STEPS is; the order is precomputed by 
+ *        buildOrder when published
  * 
  */
-void step(void) {
-    switch (status.patternMode) {
-        case 0:   
-            // repeat countdown
-            // if step is to repeat, decrease it's counter 
-            if (currPattern->steps[status.currStepIdx].counter != 0 ){
-                currPattern->steps[status.currStepIdx].counter--;
-            } else {
-                currPattern->steps[status.currStepIdx].counter = currPattern->steps[status.currStepIdx].repeat;
-                if (status.currStepIdx == 7) {
-                 status.currStepIdx = 0;
-                 } else {
-                   status.currStepIdx++;
-                 }
-            }
+bool step(void) {
+    
+    uint8_t next;
+    
+    // repeat countdown
+    // if step is to repeat, decrease it's counter 
+    if (repeatLeft != 0) {
+        repeatLeft--;
+        return true;
+    }
+    
+    // no enabled steps; stay put
+    if (currOrder->len == 0) {
+        return false;
+    }
+    
+    switch (currOrder->mode) {
+        case STEP_MODE_RANDOM:
+            // scale to the pool without a division
+            playPos = ((uint16_t)nextRandom() * currOrder->len) >> 8;
             break;
-
-        case 1: 
-            // repeat countdown
-            // if step is to repeat, decrease it's counter 
-            if (currPattern->steps[status.currStepIdx].counter != 0 ){
-                currPattern->steps[status.currStepIdx].counter--; 
+            
+        case STEP_MODE_WALK:
+            if (nextRandom() & 0x01) {
+                playPos = (playPos + 1 < currOrder->len) ? playPos + 1 : 0;
             } else {
-                currPattern->steps[status.currStepIdx].counter = currPattern->steps[status.currStepIdx].repeat;
-                if (status.currStepIdx == 0) {
-                    status.currStepIdx = 7;
-                 } else {
-                    status.currStepIdx--;
-                 }
+                playPos = playPos ? playPos - 1 : currOrder->len - 1;
             }
             break;
+            
+        default:
+            playPos = (playPos + 1 < currOrder->len) ? playPos + 1 : 0;
+            break;
     }
-
-    // RECURSIVE CALL to step()
-    // skips current step if it's not enabled
-    if (!currPattern->steps[status.currStepIdx].enable) {
-        step();
+    
+    next = currOrder->idx[playPos];
+    if (next == STEP_REST) {
+        return false;
     }
     
+    status.currStepIdx = next;
+    repeatLeft = currPattern->steps[next].repeat;
+    
     // light up current step's LED
-    stepLedsToggle(false);
-    switch(status.currStepIdx) {
-        case 0:
-            PORTD.OUTSET = PIN0_bm;
-            break;
-        case 1:
-            PORTD.OUTSET = PIN1_bm;
-            break;
-        case 2:
-            PORTD.OUTSET = PIN2_bm;
-            break;
-        case 3:
-            PORTD.OUTSET = PIN3_bm;
-            break;
-        case 4:
-            PORTC.OUTSET = PIN4_bm;
-            break;
-        case 5:
-            PORTC.OUTSET = PIN5_bm;
-            break;
-        case 6:
-            PORTC.OUTSET = PIN6_bm;
-            break;
-        case 7:
-            PORTC.OUTSET = PIN7_bm;
-            break;
-    }
+    showStep();
      
-    return;
+    return true;
     
 }
 
@@ -412,44 +656,37 @@ void step(void) {
  * 
  * @DESCRIPTION: Utilizes rotary encoder to select the current pattern  
  *               
- * @NOTE: 
+ * @PARAM: 
+ *          pins: encoder pins (PORTB.IN) captured by the PORTB ISR
+ * 
+ * @NOTE: runs from the main loop (EVT_ENCODER); the song chain owns the 
+ *        pattern in song mode, so only the encoder position is tracked. 
+ *        While the playback button is held the encoder turns the step page;
+ *        held is the queued button state, not PD4 now, as both ISRs post 
+ *        to the same queue in edge order
  * 
  */
-void selectPattern(void) {
+void selectPattern(uint8_t pins) {
+    
+    if (playHeld) {
+        turnPage(pins);
+        pageTurned = true;
+        return;
+    }
+    
+    if (status.songMode) {
+        rotaryPrevPos = pins & (PIN4_bm | PIN5_bm);
+        return;
+    }
     
     // turn off record enable for new pattern
     status.recordEnable = false;
     PORTB.OUTCLR = PIN3_bm;
     
-    rotaryTwist(true);
-    
-    currPattern = &patterns[status.currPatternIdx];
-    
-    return;
-    
-}
-
-/* @NAME: freeSampleOnGate
- * 
- * @DESCRIPTION: Samples ADC input while it's above the AC's threshold
- *               
- * @NOTE: not currently in use, but will likely be used for full gate sampling
- * 
- */
-void freeSampleOnGate(void) {
-    
-    ADC0_start();
-    
-    while(AC0.STATUS & AC_STATE_bm) {
-        while(!ADC0_conversionDone()) {
-            ;
-        }
-        
-        adcVal = ADC0free_read();
-        sendDacCommand(adcVal); 
-    }
+    rotaryTwist(pins, true);
     
-    ADC0_stop();
+    // gate ISR switches to the new pattern on its next step
+    publishPattern();
     
     return;
     
@@ -463,17 +700,10 @@ void freeSampleOnGate(void) {
  * 
  */
 void freeRunSample(void) {
-    ADC0_start();
-    
-    while(!ADC0_conversionDone()) {
-        ;
-    }
         
-    adcVal = ADC0free_read();    
+    adcVal = ADC0_next();    
     sendDacCommand(adcVal);
     
-    ADC0_stop();
-    
     return;
     
 }
@@ -482,20 +712,14 @@ void freeRunSample(void) {
  * 
  * @DESCRIPTION: Samples a one-shot of the ADC input
  *               
- * @NOTE: 
+ * @NOTE: Returns the latest oversampled result (ADC_RESULT_BITS) of the 
+ *        background conversion, so gate ISRs never wait on the ADC
  * 
  */
 uint16_t oneShotSample(void) {
     
-    ADC0_start();
-    
-    while (!ADC0_conversionDone()) {
-        ;
-    }
-    
-    adcVal = ADC0free_read();
-        
-    ADC0_stop();
+    adcVal = ADC0_latest();
+    TRACE_SAMPLE(adcVal);
     
     return adcVal;
    
@@ -508,11 +732,20 @@ uint16_t oneShotSample(void) {
  * @PARAM: 
  *          val: sample value to record to current pattern->current step's value
  * 
+ * @NOTE: in full-gate record mode this also starts the gate recording
+ *        (see recorder.h); val remains the step's one-shot value
+ * 
  */
 void recordSample(uint16_t val) {
     
     if (status.recordEnable) {
+        // live copy for playback, pattern store for editing and saving
         currPattern->steps[status.currStepIdx].value = val;
+        patterns[currPattern->idx].steps[status.currStepIdx].value = val;
+        
+        if (status.gateRecord) {
+            rec_start(currPattern->idx, status.currStepIdx);
+        }
     }
     
     return;
@@ -521,169 +754,445 @@ void recordSample(uint16_t val) {
 
 /* @NAME: setRecordEnable
  * 
- * @DESCRIPTION: Simple utility for enabling recordEnable and the record LED
+ * @DESCRIPTION: Simple utility for cycling record modes and the record LED:
+ *               off -> one-shot record -> full-gate record -> off
  *               
- * @NOTE: 
+ * @NOTE: mode is printed via USART thru USB. Nothing records in pattern 
+ *        playback, so there the button cycles the playback mode instead
  * 
  */
 void setRecordEnable(void) {
     
+    // nothing is recorded in pattern playback; the button picks the mode
+    if (!status.freeRun) {
+        setPatternMode(status.patternMode + 1);
+        return;
+    }
+    
     if (!status.recordEnable) {
         status.recordEnable = true;
+        status.gateRecord = false;
         recLedToggle(true);
-    } else if (status.recordEnable) {
+        USART3_sendString("rec one-shot\n\r");
+    } else if (!status.gateRecord) {
+        status.gateRecord = true;
+        USART3_sendString("rec gate\n\r");
+    } else {
         status.recordEnable = false;
+        status.gateRecord = false;
         recLedToggle(false);
+        USART3_sendString("rec off\n\r");
     }
 
     return;
     
 }
 
-/* @NAME: saveContext
+/* @NAME: handleEvent
  * 
- * @DESCRIPTION: Save context of system on external flash; dedicated button on PC0
+ * @DESCRIPTION: Does the work for an event posted by a port ISR; called 
+ *               from the main loop
  *               
- * @NOTE: Context stored from 0x000000 to 0x00010C
+ * @PARAM: 
+ *          evt: event taken from the queues (see events.h)
  * 
  */
-void saveContext(void) {
+void handleEvent(event_t *evt) {
     
-    USART3_sendByte(status.saved);
-    USART3_sendString("\n\r");
+    switch (evt->type) {
+        case EVT_STEP_BUTTONS:
+            toggleSteps(evt->data);
+            break;
+        case EVT_ENCODER:
+            selectPattern(evt->data);
+            break;
+        case EVT_PLAYBACK_BUTTON:
+            playbackButton(evt->data);
+            break;
+        case EVT_RECORD_BUTTON:
+            setRecordEnable();
+            break;
+        case EVT_SAVE_BUTTON:
+            saveContext();
+            break;
+    }
     
-    status.saved = true;
+    return;
+    
+}
+
+/* @NAME: contextBase
+ * 
+ * @DESCRIPTION: Returns the flash address of context copy 0 (A) or 1 (B)
+ * 
+ */
+static uint32_t contextBase(uint8_t copy) {
+    return copy ? MEM_CONTEXT_B_ADDR : MEM_CONTEXT_ADDR;
+}
+
+/* @NAME: readTrailer
+ * 
+ * @DESCRIPTION: Reads the trailer of a context copy
+ *               
+ * @PARAM: 
+ *          copy: 0 (A) or 1 (B)
+ *          seq:  returns the sequence number
+ *          crc:  returns the stored CRC
+ * 
+ * @NOTE: Returns false if the copy was never completely written
+ * 
+ */
+static bool readTrailer(uint8_t copy, uint16_t *seq, uint16_t *crc) {
+    
+    uint16_t magic;
+    
+    mem_readInit(contextBase(copy) + CONTEXT_TRAILER);
+    *seq = mem_readData() << 8;
+    *seq += mem_readData();
+    *crc = mem_readData() << 8;
+    *crc += mem_readData();
+    magic = mem_readData() << 8;
+    magic += mem_readData();
+    mem_readEnd();
+    
+    return magic == CONTEXT_MAGIC;
     
-    mem_sectorErase(0x000000);
+}
+
+/* @NAME: loadContext
+ * 
+ * @DESCRIPTION: Reads a context copy into status and patterns[], checking 
+ *               its CRC as the bytes stream in
+ *               
+ * @PARAM: 
+ *          base:  flash address of the copy
+ *          seq:   sequence number from the trailer
+ *          crc:   CRC from the trailer
+ *          check: false for a context saved before the trailer existed
+ * 
+ * @NOTE: Returns false on a CRC mismatch or out of range indices; status 
+ *        and patterns[] then hold garbage and MUST be loaded again
+ * 
+ */
+static bool loadContext(uint32_t base, uint16_t seq, uint16_t crc, bool check) {
+    
+    uint8_t steps, b;
+    uint16_t calc;
+    
+    mem_crcStart();
+    mem_readInit(base + CONTEXT_STATUS);
+            
+    status.saved = mem_readData();
+    status.currPatternIdx = mem_readData();
+    status.currStepIdx = mem_readData();
+    status.freeRun = mem_readData();
+    status.patternMode = mem_readData();
+    status.recordEnable = mem_readData();
     
-    mem_writeEnable(true);
+    for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        // saved before the clock divider: bits 7:4 clear, division 1
+        b = mem_readData();
+        patterns[pidx].idx = b & 0x0F;
+        patterns[pidx].clockDiv = (b >> 4) + 1;
+        patterns[pidx].seqLength = mem_readData();
+    }
+    steps = mem_readData();
     
-    SPI0_select(0x23, 1);
+    mem_readEnd();
     
-    SPI0_transmit(0x02);
+    // saved before the step count was stored: 8 steps. Saved with it but 
+    // before the trailer: the same layout as now. A save torn before its 
+    // trailer looks alike; its steps are either all written or partly 
+    // erased, which the repeat check below rejects
+    if (!check && steps == 0xFF) {
+        steps = 8;
+    }
     
-    // address is 0x000000
-    SPI0_transmit(0x00);
-    SPI0_transmit(0x01);
-    SPI0_transmit(0x00);
+    if (steps != NUM_STEPS) {
+        return false;
+    }
+
+    mem_readInit(base + CONTEXT_STEPS);
+
+    for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        for (int page = 0; page < NUM_PAGES; page++) {
+            patterns[pidx].enable[page] = 0;
+        }
+        for (int sidx = 0; sidx < NUM_STEPS; sidx++) {
+            b = mem_readData();
+            if (b & 0x01) {
+                patterns[pidx].enable[STEP_PAGE(sidx)] |= STEP_BIT(sidx);
+            }
+            // saved before the gate outputs: 0 or 1 only
+            patterns[pidx].steps[sidx].gate = (b >> 1) ? (b >> 1) : GATE_DEFAULT;
+            patterns[pidx].steps[sidx].value = mem_readData()<<8;
+            patterns[pidx].steps[sidx].value += mem_readData();
+            patterns[pidx].steps[sidx].repeat = mem_readData();
+        }
+    }
+
+    mem_readEnd();
     
-    SPI0_transmit(status.saved);
-    SPI0_transmit(status.currPatternIdx);
-    SPI0_transmit(status.currStepIdx);
-    SPI0_transmit(status.freeRun);
-    SPI0_transmit(status.patternMode);
-    SPI0_transmit(status.recordEnable);
+    if (check) {
+        calc = mem_crc16(mem_crc(), seq >> 8);
+        calc = mem_crc16(calc, seq & 0xFF);
+        if (calc != crc) {
+            return false;
+        }
+    }
     
-    for (int pidx = 0; pidx < 8; pidx++) {
-        SPI0_transmit(patterns[pidx].idx);
-        SPI0_transmit(patterns[pidx].seqLength);
+    // indices that address arrays are checked even with a good CRC
+    if (status.currPatternIdx >= NUM_PATTERNS || status.currStepIdx >= NUM_STEPS
+            || status.patternMode >= STEP_MODES) {
+        return false;
     }
+    for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        if (patterns[pidx].idx != pidx || patterns[pidx].clockDiv > CLOCK_DIV_MAX) {
+            return false;
+        }
+        for (int sidx = 0; sidx < NUM_STEPS; sidx++) {
+            if (patterns[pidx].steps[sidx].repeat > 2
+                    || patterns[pidx].steps[sidx].gate > GATE_MAX) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
     
-    SPI0_select(0x23, 0);
+}
 
-    mem_waitBusy();
+/* @NAME: saveContext
+ * 
+ * @DESCRIPTION: Save context of system on external flash; dedicated button on PC0
+ *               
+ * @NOTE: Copies A and B alternate, so the last good copy is never erased 
+ *        by a save; a save torn by a power loss leaves no valid trailer. 
+ *        Status at CONTEXT_STATUS, steps (4 bytes each) from CONTEXT_STEPS, 
+ *        trailer at CONTEXT_TRAILER within each copy's sector. A step's 
+ *        first byte is its enable bit with the gate length above it, a 
+ *        pattern's index byte has its clock division less one in bits 7:4
+ * 
+ */
+void saveContext(void) {
     
-    mem_writeEnable(false);
+    uint16_t value, crc;
+    uint8_t copy = contextCopy ^ 1;
+    uint16_t seq = contextSeq + 1;
+    uint32_t base = contextBase(copy);
+    uint32_t addr = base + CONTEXT_STEPS;
     
-    mem_writeEnable(true);
+    USART3_sendByte(status.saved);
+    USART3_sendString("\n\r");
+    
+    status.saved = true;
+    
+    mem_sectorErase(base);
     
-    SPI0_select(0x23, 1);
+    mem_crcStart();
+    mem_pageProgramInit(base + CONTEXT_STATUS);
     
-    SPI0_transmit(0x02);
+    mem_pageProgramData(status.saved);
+    mem_pageProgramData(status.currPatternIdx);
+    mem_pageProgramData(status.currStepIdx);
+    mem_pageProgramData(status.freeRun);
+    mem_pageProgramData(status.patternMode);
+    mem_pageProgramData(status.recordEnable);
     
-    // address is 0x000000
-    SPI0_transmit(0x00);
-    SPI0_transmit(0x00);
-    SPI0_transmit(0x00);
+    for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
+        mem_pageProgramData(patterns[pidx].idx | ((patterns[pidx].clockDiv - 1) << 4));
+        mem_pageProgramData(patterns[pidx].seqLength);
+    }
+    mem_pageProgramData(NUM_STEPS);
     
+    mem_pageProgramEnd();
+    
+    // NUM_PATTERNS * NUM_STEPS * 4 bytes is a whole number of pages
     for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
         for (int sidx = 0; sidx < NUM_STEPS; sidx++) {
-            SPI0_transmit(patterns[pidx].steps[sidx].enable);
-            SPI0_transmit(patterns[pidx].steps[sidx].value>>8);
-            SPI0_transmit(patterns[pidx].steps[sidx].value&0xFF);
-            SPI0_transmit(patterns[pidx].steps[sidx].repeat);
+            if ((addr & (MEM_PAGE_SIZE - 1)) == 0) {
+                mem_pageProgramInit(addr);
+            }
+            
+            // value may be written by the gate ISR (recordSample)
+            cli();
+            value = patterns[pidx].steps[sidx].value;
+            sei();
+            
+            mem_pageProgramData((STEP_ENABLED(&patterns[pidx], sidx) != 0)
+                    | (patterns[pidx].steps[sidx].gate << 1));
+            mem_pageProgramData(value>>8);
+            mem_pageProgramData(value&0xFF);
+            mem_pageProgramData(patterns[pidx].steps[sidx].repeat);
+            addr += 4;
+            
+            if ((addr & (MEM_PAGE_SIZE - 1)) == 0) {
+                mem_pageProgramEnd();
+            }
         }
     }
     
-    SPI0_select(0x23, 0);
+    crc = mem_crc16(mem_crc(), seq >> 8);
+    crc = mem_crc16(crc, seq & 0xFF);
     
-    mem_waitBusy();
+    // trailer last; the rest of the status page is still erased
+    mem_pageProgramInit(base + CONTEXT_TRAILER);
+    mem_pageProgramData(seq >> 8);
+    mem_pageProgramData(seq & 0xFF);
+    mem_pageProgramData(crc >> 8);
+    mem_pageProgramData(crc & 0xFF);
+    mem_pageProgramData(CONTEXT_MAGIC >> 8);
+    mem_pageProgramData(CONTEXT_MAGIC & 0xFF);
+    mem_pageProgramEnd();
     
-    mem_writeEnable(false);
+    contextCopy = copy;
+    contextSeq = seq;
     
     USART3_sendByte(status.saved);
     USART3_sendString("\n\r");
 
 }
-
 /* @NAME: restoreContext
  * 
  * @DESCRIPTION: Restore context of system from external flash; runs on boot up
  *               
- * @NOTE: Context stored from 0x000000 to 0x00010C
+ * @NOTE: The newer complete copy is loaded; if its CRC fails the other one 
+ *        is. A context saved before the A/B copies existed (with or without 
+ *        the step count) is only range checked, and loaded when neither 
+ *        copy is valid. Factory settings otherwise
  * 
  */
 void restoreContext(void) {
 
-    SPI0_select(0x23, 1);
-
-    mem_readInit(0x000100);
-            
-    status.saved = SPI0_transmit(0);
-    status.currPatternIdx = SPI0_transmit(0);
-    status.currStepIdx = SPI0_transmit(0);
-    status.freeRun = SPI0_transmit(0);
-    status.patternMode = SPI0_transmit(0);
-    status.recordEnable = SPI0_transmit(0);
+    bool valid[2];
+    uint16_t seq[2], crc[2];
+    uint8_t copy;
     
-
-
-    for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
-        patterns[pidx].idx = SPI0_transmit(0);
-        patterns[pidx].seqLength = SPI0_transmit(0);
-    }
+    valid[0] = readTrailer(0, &seq[0], &crc[0]);
+    valid[1] = readTrailer(1, &seq[1], &crc[1]);
     
-    SPI0_select(0x23, 0);
+    // newer copy first; sequence numbers wrap
+    copy = (valid[1] && (!valid[0] || (int16_t)(seq[1] - seq[0]) > 0)) ? 1 : 0;
     
-    if (status.saved) {
-
-        SPI0_select(0x23, 1);
-
-        mem_readInit(0x000000);
-
-        for (int pidx = 0; pidx < NUM_PATTERNS; pidx++) {
-            for (int sidx = 0; sidx < NUM_STEPS; sidx++) {
-                patterns[pidx].steps[sidx].enable = SPI0_transmit(0);
-                patterns[pidx].steps[sidx].value = SPI0_transmit(0)<<8;
-                patterns[pidx].steps[sidx].value += SPI0_transmit(0);
-                patterns[pidx].steps[sidx].repeat = SPI0_transmit(0);
-            }
+    for (uint8_t i = 0; i < 2; i++, copy ^= 1) {
+        if (!valid[copy]) {
+            continue;
         }
-
-        SPI0_select(0x23, 0);
-
-        currPattern = &patterns[status.currPatternIdx];
+        
+        if (loadContext(contextBase(copy), seq[copy], crc[copy], true)) {
+            contextCopy = copy;
+            contextSeq = seq[copy];
+            loadPattern();
+            return;
+        }
+        
+        USART3_sendString("context ");
+        USART3_sendString(copy ? "B" : "A");
+        USART3_sendString(" bad\n\r");
+    }
+    
+    // next save goes to copy A
+    contextCopy = 1;
+    contextSeq = 0;
+    
+    if (loadContext(MEM_CONTEXT_ADDR, 0, 0, false) && status.saved == true) {
+        loadPattern();
     } else {
         sequencer_init();
     }
     
 }
 
+/* @NAME: factoryReset
+ * 
+ * @DESCRIPTION: Returns the sequencer to FACTORY SETTINGS and deletes the 
+ *               stored context, song and recordings; hold the playback 
+ *               button (PD4) on boot
+ *               
+ * @NOTE: The calibration is kept. The 2MB of recordings are erased in the 
+ *        background, so the sequencer is playable at once
+ * 
+ */
+void factoryReset(void) {
+    
+    USART3_sendString("factory reset\n\r");
+    
+    // the release would otherwise cycle the playback mode
+    while (!(PORTD.IN & PIN4_bm)) {
+        ;
+    }
+    PORTD.INTFLAGS = PIN4_bm;
+    
+    mem_sectorErase(MEM_CONTEXT_ADDR);
+    mem_sectorErase(MEM_CONTEXT_B_ADDR);
+    mem_sectorErase(MEM_SONG_ADDR);
+    song_load();
+    rec_clear();
+    
+    // next save goes to copy A
+    contextCopy = 1;
+    contextSeq = 0;
+    
+    sequencer_init();
+    
+}
+
+/* @NAME: setPatternMode
+ * 
+ * @DESCRIPTION: Selects the playback mode (wraps past the last one) and 
+ *               republishes the pattern with the new play order
+ *               
+ * @PARAM: 
+ *          mode: STEP_MODE_* playback mode
+ * 
+ */
+void setPatternMode(uint8_t mode) {
+    
+    static const char *names[STEP_MODES] = {
+        "forward", "backward", "ping-pong", "random", "random walk", "euclidean"
+    };
+    
+    status.patternMode = (mode < STEP_MODES) ? mode : STEP_MODE_FORWARD;
+    publishPattern();
+    
+    USART3_sendString((char *)names[status.patternMode]);
+    USART3_sendString("\n\r");
+    
+    return;
+    
+}
+
 /* @NAME: setPlaybackEnable
  * 
  * @DESCRIPTION: Simple utility for enabling freeRun and the pattern playback LED
  *               
- * @NOTE: 
+ * @NOTE: cycles freeRun -> pattern playback -> song (if one is stored) -> 
+ *        freeRun
  * 
  */
 void setPlaybackEnable(void) {
     
-    if (!status.freeRun) {
+    if (status.songMode) {
+        status.songMode = false;
+        song_stop();
         status.freeRun = true;
+        play_stop();
         playbackLedToggle(true);
+        USART3_sendString("free run\n\r");
+    } else if (!status.freeRun) {
+        if (song_start()) {
+            status.songMode = true;
+            USART3_sendString("song\n\r");
+        } else {
+            status.freeRun = true;
+            play_stop();
+            playbackLedToggle(true);
+            USART3_sendString("free run\n\r");
+        }
     } else if (status.freeRun) {
         status.freeRun = false;
         playbackLedToggle(false);
+        USART3_sendString("pattern\n\r");
     }
 
     return;
@@ -693,31 +1202,59 @@ void setPlaybackEnable(void) {
 /* @NAME: playbackPattern
  * 
  * @DESCRIPTION: Sends the oneshot sample for current pattern->current step to DAC 
+ *               and starts streaming the step's full-gate recording, if any
  *               
- * @NOTE: INCOMPLETE. Only accounts for oneshots
+ * @NOTE: see player.h
  * 
  */
 void playbackPattern(void) {
     sendDacCommand(currPattern->steps[status.currStepIdx].value);
+    play_start(currPattern->idx, status.currStepIdx);
 }
 
 /* @NAME: sendDacCommand
  * 
- * @DESCRIPTION: Sends a DAC command to the MCP4922
+ * @DESCRIPTION: Sends a calibrated DAC command to the MCP4922
  *               
  * @PARAM: 
- *          command: 16-bit ADC sampled voltage for D/A conversion
+ *          command: ADC sampled voltage for D/A conversion
+ * 
+ * @NOTE: calibration is a calTable lookup (see calibration.h)
  * 
  */
 void sendDacCommand(uint16_t command) {
+    sendDacRaw(cal_lookup(command));
+}
+
+/* @NAME: sendDacRaw
+ * 
+ * @DESCRIPTION: Sends an uncalibrated DAC command to the MCP4922
+ *               
+ * @PARAM: 
+ *          code: 12-bit DAC code
+ * 
+ * @NOTE: Safe from any ISR; a frame is never interleaved with another
+ * 
+ */
+void sendDacRaw(uint16_t code) {
     // 0x5000 sets up MCP4922 for DACA output, input buffer ON, x2 output gain
-    dacCommandH = 0x50 + (command >> 8);
-    dacCommandL = command & 0xFF;
-    
-    SPI0_dacSelect(true);
-    SPI0_transmit(dacCommandH);
-    SPI0_transmit(dacCommandL);
-    SPI0_dacSelect(false);
+    uint8_t high = 0x50 + (code >> 8);
+    uint8_t low = code & 0xFF;
+    uint8_t sreg = SREG;
+    
+    // the gate ISR may send a frame of its own in the middle of this one
+    cli();
+    dacCommandH = high;
+    dacCommandL = low;
+    
+#ifdef DAC_USART
+    // own bus, returns while the frame shifts (see dac.h)
+    dac_write(high, low);
+#else
+    // preempts any flash transfer in progress (see spi.h)
+    SPI0_dacWrite(high, low);
+#endif
+    SREG = sreg;
     
     return;
     
@@ -782,44 +1319,160 @@ void stepLedsToggle(bool toggle) {
     
 }
 
-/* @NAME: rotaryTwist
+/* @NAME: rotaryDecode
  * 
- * @DESCRIPTION: Handles twisting of rotary knob for patternSelect
+ * @DESCRIPTION: Decodes an encoder edge into a detent
  *               
  * @PARAM: 
- *          print: if true, currPatternIdx is printed via USART thru USB
+ *          pins: encoder pins (PORTB.IN) captured on the edge
+ * 
+ * @NOTE: returns 1 clockwise, -1 counterclockwise, 0 between detents
  * 
  */
-               void rotaryTwist(bool print) {
+static int8_t rotaryDecode(uint8_t pins) {
+    
+    int8_t dir = 0;
+    
     //stores the current position of the rotary encoders
-    rotaryPos = (PORTB.IN & PIN4_bm) | (PORTB.IN & PIN5_bm);
+    rotaryPos = pins & (PIN4_bm | PIN5_bm);
     
     //clockwise rotation
     if((rotaryPos == 32 && rotaryPrevPos == 48)) {
-        if (status.currPatternIdx == 7) {
-            status.currPatternIdx = 0;
-        } else {
-            status.currPatternIdx++;            
-        }
-        if (print) {
-            USART3_sendNum(status.currPatternIdx);
-        }
+        dir = 1;
     }
     //counterclockwise rotation
     else if((rotaryPos == 16 && rotaryPrevPos == 48)) {
-        if (status.currPatternIdx == 0) {
-            status.currPatternIdx = 7;
-        } else {
-            status.currPatternIdx--;
-        }
-        if (print) {
-            USART3_sendNum(status.currPatternIdx);
-        }
+        dir = -1;
     }  
     
     //updates the previous position
     rotaryPrevPos = rotaryPos;
     
+    return dir;
+    
+}
+
+/* @NAME: rotaryTwist
+ * 
+ * @DESCRIPTION: Handles twisting of rotary knob for patternSelect
+ *               
+ * @PARAM: 
+ *          pins:  encoder pins (PORTB.IN) captured on the edge
+ *          print: if true, currPatternIdx is printed via USART thru USB
+ * 
+ * @NOTE: The index is read and written with interrupts off, so a song 
+ *        boundary in between is not undone
+ * 
+ */
+void rotaryTwist(uint8_t pins, bool print) {
+    
+    int8_t dir = rotaryDecode(pins);
+    uint8_t sreg, idx;
+    
+    if (dir == 0) {
+        return;
+    }
+    
+    // song_tick also sets it, from the gate ISR
+    sreg = SREG;
+    cli();
+    idx = (status.currPatternIdx + NUM_PATTERNS + dir) % NUM_PATTERNS;
+    status.currPatternIdx = idx;
+    SREG = sreg;
+    
+    if (print) {
+        USART3_sendNum(idx);
+    }
+    
+    return;
+    
+}
+
+/* @NAME: turnPage
+ * 
+ * @DESCRIPTION: Moves the step buttons and LEDs to the next/previous page 
+ *               of NUM_STEPS
+ *               
+ * @PARAM: 
+ *          pins: encoder pins (PORTB.IN) captured on the edge
+ * 
+ * @NOTE: page is printed via USART thru USB
+ * 
+ */
+void turnPage(uint8_t pins) {
+    
+    int8_t dir = rotaryDecode(pins);
+    uint8_t sreg;
+    
+    if (dir == 0) {
+        return;
+    }
+    
+    status.page = (status.page + NUM_PAGES + dir) % NUM_PAGES;
+    
+    // the gate ISR also drives the step LEDs
+    sreg = SREG;
+    cli();
+    showStep();
+    SREG = sreg;
+    
+    USART3_sendString("page ");
+    USART3_sendNum(status.page);
+    
+    return;
+    
+}
+
+/* @NAME: playbackButton
+ * 
+ * @DESCRIPTION: Handles both edges of the playback button; a press and 
+ *               release cycles the playback mode (setPlaybackEnable)
+ *               
+ * @PARAM: 
+ *          pins: PORTD.IN captured by the PORTD ISR
+ * 
+ * @NOTE: holding the button turns the encoder into the page select, and 
+ *        a release after a page turn leaves the mode alone
+ * 
+ */
+void playbackButton(uint8_t pins) {
+    
+    playHeld = !(pins & PIN4_bm);
+    
+    // pressed
+    if (playHeld) {
+        pageTurned = false;
+        return;
+    }
+    
+    if (!pageTurned) {
+        setPlaybackEnable();
+    }
+    pageTurned = false;
+    
+    return;
+    
+}
+
+/* @NAME: showStep
+ * 
+ * @DESCRIPTION: Lights the current step's LED if it is on the shown page
+ *               
+ * @NOTE: LED n is PD0-PD3 for n < 4 and PC4-PC7 otherwise, i.e. the same 
+ *        bit as the step's button
+ * 
+ */
+void showStep(void) {
+    
+    uint8_t bit = STEP_BIT(status.currStepIdx);
+    
+    stepLedsToggle(false);
+    
+    if (STEP_PAGE(status.currStepIdx) == status.page) {
+        PORTD.OUTSET = bit & 0x0F;
+        PORTC.OUTSET = bit & 0xF0;
+    }
+    
     return;
     
 }
\ No newline at end of file
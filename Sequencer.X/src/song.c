@@ -0,0 +1,304 @@
+/*
+ * File:   song.c
+ * Author: N Mark
+ *
+ * Song mode: chained patterns with the next pattern staged ahead of time.
+ *
+ * The ISR side (song_tick) only counts gates and releases the staged
+ * pattern; everything that walks patterns or the chain happens in
+ * song_service() from the main loop.
+ */
+
+#include "sequencer_utils.h"
+#include "song.h"
+
+/*
+ * local variables
+ */
+static song_entry_t song[SONG_MAX_ENTRIES];
+static uint8_t songLen;                 // entries in the chain
+static volatile bool songActive;        // song_tick is counting
+static volatile bool songWant;          // ISR asks for the next entry to be staged
+static volatile bool songStaged;        // next entry is staged
+static volatile uint16_t songLeft;      // gates left before the boundary gate
+static volatile uint16_t songPass;      // gates per pass of the current entry
+static volatile uint8_t songPos;        // current entry
+static volatile uint16_t songLate;      // boundaries reached before staging
+/* next entry, written by song_service before the pattern is staged */
+static uint8_t songNextPos;
+static uint16_t songNextPass;
+static uint16_t songNextGates;
+
+/* @NAME: song_init
+ *
+ * @DESCRIPTION: Loads the chain on boot, or runs song_edit when the record
+ *               button (PF2) is held during power-up
+ *
+ * @NOTE: MUST run after io_init, USART3_init and mem_init
+ *
+ */
+void song_init(void) {
+
+    if (!(PORTF.IN & PIN2_bm)) {
+        song_edit();
+    } else {
+        song_load();
+    }
+
+    return;
+
+}
+
+/* @NAME: song_edit
+ *
+ * @DESCRIPTION: Enters the chain over USART3 and stores it in flash
+ *
+ */
+void song_edit(void) {
+
+    uint16_t n;
+
+    USART3_sendString("\n\rSong entries (0 keeps the stored song): ");
+    n = USART3_readNum();
+    USART3_sendString("\n\r");
+
+    if (n == 0) {
+        song_load();
+        return;
+    }
+    if (n > SONG_MAX_ENTRIES) {
+        n = SONG_MAX_ENTRIES;
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        USART3_sendString("Pattern 0-7: ");
+        song[i].pattern = USART3_readNum() & (NUM_PATTERNS - 1);
+        USART3_sendString("  repeats: ");
+        song[i].repeats = USART3_readNum();
+        if (song[i].repeats == 0) {
+            song[i].repeats = 1;
+        }
+        USART3_sendString("\n\r");
+    }
+    songLen = n;
+
+    song_store();
+
+    USART3_sendString("Song stored\n\r");
+
+    return;
+
+}
+
+/* @NAME: song_load
+ *
+ * @DESCRIPTION: Loads the chain from flash; no chain without the magic word
+ *
+ * @NOTE: A stored 0 repeats plays once, like an entered one
+ *
+ */
+void song_load(void) {
+
+    uint16_t magic;
+
+    mem_readInit(MEM_SONG_ADDR);
+    magic = mem_readData() << 8;
+    magic += mem_readData();
+    songLen = mem_readData();
+
+    if (magic != SONG_MAGIC || songLen > SONG_MAX_ENTRIES) {
+        songLen = 0;
+    }
+
+    for (uint8_t i = 0; i < songLen; i++) {
+        song[i].pattern = mem_readData() & (NUM_PATTERNS - 1);
+        song[i].repeats = mem_readData();
+        if (song[i].repeats == 0) {
+            song[i].repeats = 1;
+        }
+    }
+    mem_readEnd();
+
+    return;
+
+}
+
+/* @NAME: song_store
+ *
+ * @DESCRIPTION: Stores the chain in flash
+ *
+ * @NOTE: Magic word, entry count, then pattern/repeats pairs; the chain 
+ *        fits a single page
+ *
+ */
+void song_store(void) {
+
+    mem_sectorErase(MEM_SONG_ADDR);
+
+    mem_pageProgramInit(MEM_SONG_ADDR);
+    mem_pageProgramData(SONG_MAGIC >> 8);
+    mem_pageProgramData(SONG_MAGIC & 0xFF);
+    mem_pageProgramData(songLen);
+    for (uint8_t i = 0; i < songLen; i++) {
+        mem_pageProgramData(song[i].pattern);
+        mem_pageProgramData(song[i].repeats);
+    }
+    mem_pageProgramEnd();
+
+    return;
+
+}
+
+/* @NAME: song_stage
+ *
+ * @DESCRIPTION: Stages the given entry as the next one
+ *
+ */
+static void song_stage(uint8_t pos) {
+
+    songNextPos = pos;
+    songNextPass = passGates(song[pos].pattern);
+    songNextGates = songNextPass * song[pos].repeats;
+
+    // held until song_tick releases it on the boundary gate
+    stagePattern(song[pos].pattern, true);
+    songStaged = true;
+
+    return;
+
+}
+
+/* @NAME: song_start
+ *
+ * @DESCRIPTION: Starts the chain from its first entry on the next gate
+ *
+ * @NOTE: Returns false if no song is stored
+ *
+ */
+bool song_start(void) {
+
+    if (songLen == 0) {
+        return false;
+    }
+
+    song_stage(0);
+
+    cli();
+    songLeft = 0;
+    songPass = 1;
+    songWant = false;
+    songLate = 0;
+    songActive = true;
+    sei();
+
+    return true;
+
+}
+
+/* @NAME: song_stop
+ *
+ * @DESCRIPTION: Leaves song mode; the current pattern keeps looping
+ *
+ */
+void song_stop(void) {
+
+    songActive = false;
+    songStaged = false;
+
+    // replaces (and un-holds) any staged entry
+    stagePattern(status.currPatternIdx, false);
+
+    if (songLate) {
+        USART3_sendString("song late ");
+        USART3_sendWord(songLate);
+        USART3_sendString("\n\r");
+    }
+
+    return;
+
+}
+
+/* @NAME: song_tick
+ *
+ * @DESCRIPTION: Counts a gate; called from the gate ISR before swapPattern
+ *
+ * @NOTE: Returns true on an entry boundary, where the caller restarts the
+ *        (new) pattern. If the next entry is not staged in time the
+ *        current one plays another pass and the boundary is counted late
+ *
+ */
+bool song_tick(void) {
+
+    if (!songActive) {
+        return false;
+    }
+
+    if (songLeft) {
+        if (--songLeft == SONG_PREFETCH_STEPS) {
+            songWant = true;
+        }
+        return false;
+    }
+
+    if (songStaged && releasePattern()) {
+        songStaged = false;
+        songPos = songNextPos;
+        songPass = songNextPass;
+        songLeft = songNextGates - 1;
+        status.currPatternIdx = song[songPos].pattern;
+    } else {
+        songLate++;
+        songLeft = songPass - 1;
+    }
+
+    if (songLeft <= SONG_PREFETCH_STEPS) {
+        songWant = true;
+    }
+
+    return true;
+
+}
+
+/* @NAME: song_service
+ *
+ * @DESCRIPTION: Stages the next entry when song_tick asks for it; called
+ *               from the main loop
+ *
+ */
+void song_service(void) {
+
+    uint8_t next;
+
+    if (!songWant) {
+        return;
+    }
+    songWant = false;
+
+    if (!songActive || songStaged) {
+        return;
+    }
+
+    next = songPos + 1;
+    if (next == songLen) {
+        next = 0;
+    }
+
+    song_stage(next);
+
+    // the entry may stream a recording from its downbeat on
+    if (rec_patternRecorded(song[next].pattern)) {
+        mem_wake();
+    }
+
+    return;
+
+}
+
+/* @NAME: song_pending
+ *
+ * @DESCRIPTION: Returns true while song_service has an entry to stage
+ *
+ */
+bool song_pending(void) {
+    return songWant;
+}
@@ -13,6 +13,7 @@
  *  @VERSION: 1.1
  */
 
+#include <avr/interrupt.h>
 #include "spi.h"
 
 static register8_t* PORTx_OUTSET[6] = {
@@ -33,10 +34,34 @@ static register8_t* PORTx_OUTCLR[6] = {
     &(PORTF.OUTCLR),
 };
 
+static register8_t* PORTx_DIRSET[6] = {
+    &(PORTA.DIRSET), 
+    &(PORTB.DIRSET), 
+    &(PORTC.DIRSET),
+    &(PORTD.DIRSET),
+    &(PORTE.DIRSET),
+    &(PORTF.DIRSET),
+};
+
 static uint8_t PINx_bm[8] = {
     PIN0_bm, PIN1_bm, PIN2_bm, PIN3_bm, PIN4_bm, PIN5_bm, PIN6_bm, PIN7_bm
 };
 
+/* CLK_PER per SCK by SPI_PRESC_gm, without CLK2X */
+static uint8_t SPI0_DIV[4] = {4, 16, 64, 128};
+
+typedef struct {
+    uint8_t addr;           // slave, 0 if the entry is free
+    uint8_t ctrla;          // prescaler and CLK2X
+    uint8_t ctrlb;          // mode
+} spi0_profile_t;
+
+static spi0_profile_t spi0_profiles[SPI0_PROFILES];
+static uint8_t spi0_applied;            // slave whose profile is in SPI0, 0 if the init one
+
+static volatile uint8_t spi0_stream;    // slave of the open transaction, 0 if none
+static volatile bool spi0_preempted;    // a DAC frame broke into the transaction
+
 /*  Initializes and configures the SPI0 module
  *
  *  SPI0 module is multiplex to different ports based on the muxSel value.
@@ -73,6 +98,7 @@ void SPI0_init(uint8_t muxSel)
     
     //enables the spi peripheral
     SPI0 = spi0_config; 
+    spi0_applied = 0;
     
     //SPI0 on PC[3:0]
     if(muxSel == 1){
@@ -99,14 +125,92 @@ void SPI0_init(uint8_t muxSel)
  *  Writes data to be transmitted over the SPI0 lane to the SPIx.DATA register.
  *  Then waits for data to be successfully transmitted before returning. If the
  *  transmission is successful, SPIx.DATA will return '0x00'.
+ *  Interrupts are held off for the byte so frames never interleave mid-byte.
  */
 uint8_t SPI0_transmit(uint8_t data)
 { 
+    uint8_t sreg = SREG;
+    
+    cli();
     SPI0.DATA = data;
     
     while(!(SPI0.INTFLAGS & SPI_IF_bm)){;}
     
-    return SPI0.DATA; 
+    data = SPI0.DATA;
+    SREG = sreg;
+    
+    return data; 
+}
+
+/* Loads a slave's profile (or the init settings) into SPI0.
+ * 
+ * Only called between transactions, with no byte in flight.
+ */
+static void SPI0_apply(uint8_t addr)
+{
+    uint8_t ctrla = spi0_config.CTRLA;
+    uint8_t ctrlb = spi0_config.CTRLB;
+    
+    spi0_applied = 0;
+    for(uint8_t i = 0; i < SPI0_PROFILES; i++){
+        if(spi0_profiles[i].addr == addr){
+            ctrla = (ctrla & ~(SPI_PRESC_gm | SPI_CLK2X_bm)) | spi0_profiles[i].ctrla;
+            ctrlb = (ctrlb & ~SPI_MODE_gm) | spi0_profiles[i].ctrlb;
+            spi0_applied = addr;
+            break;
+        }
+    }
+    
+    SPI0.CTRLB = ctrlb;
+    SPI0.CTRLA = ctrla;
+}
+
+/* Sets the clock and mode used for a slave from its next select on.
+ */
+void SPI0_profile(uint8_t addr, uint8_t clock, uint8_t mode)
+{
+    uint8_t sreg = SREG;
+    uint8_t i;
+    
+    cli();
+    for(i = 0; i < SPI0_PROFILES; i++){
+        if(spi0_profiles[i].addr == addr || spi0_profiles[i].addr == 0){
+            break;
+        }
+    }
+    
+    if(i < SPI0_PROFILES){
+        spi0_profiles[i].addr = addr;
+        spi0_profiles[i].ctrla = clock & (SPI_PRESC_gm | SPI_CLK2X_bm);
+        spi0_profiles[i].ctrlb = mode & SPI_MODE_gm;
+        // reloaded on the slave's next select
+        if(spi0_applied == addr){
+            spi0_applied = 0xFF;
+        }
+    }
+    SREG = sreg;
+}
+
+/* Returns the CLK_PER cycles of one byte with a slave's profile.
+ */
+uint16_t SPI0_byteClocks(uint8_t addr)
+{
+    uint8_t ctrla = spi0_config.CTRLA;
+    uint16_t clocks;
+    
+    for(uint8_t i = 0; i < SPI0_PROFILES; i++){
+        if(spi0_profiles[i].addr == addr){
+            ctrla = spi0_profiles[i].ctrla;
+            break;
+        }
+    }
+    
+    clocks = 8 * SPI0_DIV[(ctrla & SPI_PRESC_gm) >> SPI_PRESC_gp];
+    if(ctrla & SPI_CLK2X_bm){
+        clocks >>= 1;
+    }
+    
+    return clocks;
 }
 
 /* Selects the slave pin.
@@ -122,9 +226,106 @@ uint8_t SPI0_transmit(uint8_t data)
 void SPI0_select(uint8_t addr, uint8_t sel)
 {
     if(sel){
+        if(addr != spi0_applied){
+            SPI0_apply(addr);
+        }
         *PORTx_OUTCLR[addr >> 4] = PINx_bm[addr & 0xF];
     }
     else{
         *PORTx_OUTSET[addr >> 4] = PINx_bm[addr & 0xF];
     }
 }
+
+/* Configures a slave select pin as an output, deselected.
+ */
+void SPI0_slaveInit(uint8_t addr)
+{
+    SPI0_select(addr, 0);
+    *PORTx_DIRSET[addr >> 4] = PINx_bm[addr & 0xF];
+}
+
+/* Opens a preemptible transaction.
+ * 
+ * Selects the slave and records it as the stream owner so a DAC frame
+ * can release its chip select.
+ */
+void SPI0_streamOpen(uint8_t addr)
+{
+    uint8_t sreg = SREG;
+    
+    cli();
+    spi0_preempted = false;
+    spi0_stream = addr;
+    SPI0_select(addr, 1);
+    SREG = sreg;
+}
+
+/* Shifts one byte of an open transaction.
+ * 
+ * Returns false, without sending, once the transaction has been preempted;
+ * the owner must re-open it before continuing.
+ */
+bool SPI0_streamByte(uint8_t data, uint8_t *rx)
+{
+    uint8_t sreg = SREG;
+    
+    cli();
+    if(spi0_preempted){
+        SREG = sreg;
+        return false;
+    }
+    *rx = SPI0_transmit(data);
+    SREG = sreg;
+    
+    return true;
+}
+
+/* Returns true if the open transaction has been preempted.
+ */
+bool SPI0_streamPreempted(void)
+{
+    return spi0_preempted;
+}
+
+/* Closes the open transaction.
+ * 
+ * Returns false if it was preempted since it was opened, i.e. the slave saw
+ * its chip select rise early and the transaction must be repeated.
+ */
+bool SPI0_streamClose(void)
+{
+    bool intact;
+    uint8_t sreg = SREG;
+    
+    cli();
+    SPI0_select(spi0_stream, 0);
+    intact = !spi0_preempted;
+    spi0_stream = 0;
+    spi0_preempted = false;
+    SREG = sreg;
+    
+    return intact;
+}
+
+/* Sends a frame to the DAC with priority over any open transaction.
+ * 
+ * The open transaction's chip select is raised first (the slave sees a
+ * complete number of bytes, as shifting is atomic) and the transaction is
+ * marked preempted.
+ */
+void SPI0_dacWrite(uint8_t high, uint8_t low)
+{
+    uint8_t sreg = SREG;
+    
+    cli();
+    if(spi0_stream && !spi0_preempted){
+        SPI0_select(spi0_stream, 0);
+        spi0_preempted = true;
+    }
+    
+    SPI0_select(SPI0_DAC_SS, 1);
+    SPI0_transmit(high);
+    SPI0_transmit(low);
+    SPI0_select(SPI0_DAC_SS, 0);
+    SREG = sreg;
+}
@@ -0,0 +1,118 @@
+/*
+ * File:   stack.c
+ * Author: N Mark
+ *
+ * Stack painting at boot and the high-water mark/ISR depth reports.
+ */
+
+#include "sequencer_utils.h"
+#include "stack.h"
+
+/* linker symbols: end of .data/.bss/.noinit and the initial SP (RAMEND) */
+extern uint8_t _end;
+extern uint8_t __stack;
+
+/*
+ * local variables
+ */
+volatile uint16_t stackIsrDepth[STACK_ISRS];    // deepest SP seen per ISR
+#ifdef STACK_MONITOR
+static uint16_t stackReported;                  // high-water mark last printed
+static uint16_t stackIsrReported[STACK_ISRS];   // ISR depths last printed
+#endif
+
+void stack_paint(void) __attribute__((naked, used, section(".init3")));
+
+/* @NAME: stack_paint
+ *
+ * @DESCRIPTION: Fills the free SRAM with STACK_PAINT
+ *
+ * @NOTE: Runs from .init3, after SP and the zero register are set up and
+ *        before .data/.bss are initialized; nothing is on the stack yet
+ *        and the loop lives in registers. NEVER call it
+ *
+ */
+void stack_paint(void) {
+
+    uint8_t *p = &_end;
+
+    while (p <= &__stack) {
+        *p++ = STACK_PAINT;
+    }
+
+}
+
+/* @NAME: stack_size
+ *
+ * @DESCRIPTION: Returns the bytes between the end of .bss and RAMEND,
+ *               i.e. what the stack may grow into
+ *
+ */
+uint16_t stack_size(void) {
+    return &__stack - &_end + 1;
+}
+
+/* @NAME: stack_highWater
+ *
+ * @DESCRIPTION: Returns the most bytes of stack used since reset
+ *
+ * @NOTE: Scans up from _end to the first overwritten byte, so the cost is
+ *        proportional to the headroom left
+ *
+ */
+uint16_t stack_highWater(void) {
+
+    uint8_t *p = &_end;
+
+    while (p <= &__stack && *p == STACK_PAINT) {
+        p++;
+    }
+
+    return &__stack - p + 1;
+
+}
+
+/* @NAME: stack_report
+ *
+ * @DESCRIPTION: Prints any new maximum of the high-water mark and of the
+ *               ISR depths via USART3; called from the main loop
+ *
+ */
+void stack_report(void) {
+
+#ifdef STACK_MONITOR
+    static const char *names[STACK_ISRS] = {
+        "ac0", "rtc", "adc0", "tcb2", "porta", "portb", "portc", "portd", "portf",
+        "tcb3", "usart1", "usart2", "tca0"
+    };
+    uint16_t used = stack_highWater();
+    uint16_t depth;
+
+    if (used != stackReported) {
+        stackReported = used;
+        USART3_sendString("stack max ");
+        USART3_sendWord(used);
+        USART3_sendString(" free ");
+        USART3_sendWord(stack_size() - used);
+        USART3_sendString("\n\r");
+    }
+
+    for (uint8_t isr = 0; isr < STACK_ISRS; isr++) {
+        cli();
+        depth = stackIsrDepth[isr];
+        sei();
+
+        if (depth != stackIsrReported[isr]) {
+            stackIsrReported[isr] = depth;
+            USART3_sendString("stack ");
+            USART3_sendString((char *)names[isr]);
+            USART3_sendString(" ");
+            USART3_sendWord(depth);
+            USART3_sendString("\n\r");
+        }
+    }
+#endif
+
+    return;
+
+}
@@ -83,6 +83,20 @@ void USART3_sendNum(uint8_t num){
     USART3_sendString(buff);
 }
 
+/* @NAME: USART3_sendWord
+ * 
+ * @DESCRIPTION: takes a 16-bit number and outputs it out as an ascii decimal number
+ * 
+ * @PARAM:
+ *          num: number to be converted and sent to the terminal
+ *
+ */
+void USART3_sendWord(uint16_t num){
+    char buff[6] = {0};
+    utoa(num, buff, 10);
+    USART3_sendString(buff);
+}
+
 /* @NAME: USART3_sendHex
  * 
  * @DESCRITPION: takes a number and outputs it out as an ascii number as a hex number
@@ -111,3 +125,25 @@ uint8_t USART3_read(){
     return USART3.RXDATAL; //returns the value of the receive register
 }
 
+/* @NAME: USART3_readNum
+ * 
+ * @DESCRIPTION: reads a decimal number from the terminal, echoing each digit,
+ *               until enter is pressed and returns it
+ * 
+ * @NOTE: non-digit characters are ignored
+ *
+ */
+uint16_t USART3_readNum(){
+    uint16_t num = 0;
+    char c = USART3_read();
+    
+    while(c != '\r' && c != '\n'){
+        if(c >= '0' && c <= '9'){
+            num = num * 10 + (c - '0');
+            USART3_sendChar(c); //echoes the digit back to the terminal
+        }
+        c = USART3_read();
+    }
+    
+    return num;
+}
@@ -0,0 +1,202 @@
+/*
+ * File:   trace.c
+ * Author: N Mark
+ *
+ * Event trace ring and its USART3 stream; see trace.h.
+ *
+ * The ring is single-consumer (main loop) but has producers on both
+ * interrupt levels, so trace_record() runs with interrupts disabled.
+ */
+
+#include "sequencer_utils.h"
+#include "trace.h"
+
+#if defined(TRACE_CAPTURE) && defined(PWR_LATENCY)
+#error "TRACE_CAPTURE and PWR_LATENCY both need TCB3"
+#endif
+
+#if (TRACE_RECORDS & (TRACE_RECORDS - 1)) || TRACE_RECORDS > 128
+#error "TRACE_RECORDS must be a power of 2 up to 128"
+#endif
+
+/*
+ * local variables
+ */
+#ifdef TRACE_CAPTURE
+static trace_rec_t traceRing[TRACE_RECORDS];
+static volatile uint8_t traceHead;      // next entry to write (producers)
+static volatile uint8_t traceTail;      // next entry to send (main loop)
+static volatile uint16_t traceWraps;    // TCB3 wraps, upper half of the time
+static uint32_t traceLast;              // time of the last record kept
+static uint8_t traceLost;               // records dropped since then
+#endif
+
+/* @NAME: trace_init
+ *
+ * @DESCRIPTION: Enables the TCB3 wrap interrupt and records TRACE_START
+ *
+ * @NOTE: MUST run after bench_init; TCB3 wraps at CCMP (0xFFFF)
+ *
+ */
+void trace_init(void) {
+
+#ifdef TRACE_CAPTURE
+    TCB3.INTFLAGS = TCB_CAPT_bm;
+    TCB3.INTCTRL = TCB_CAPT_bm;
+
+    trace_record(TRACE_START, NUM_STEPS);
+#endif
+
+    return;
+
+}
+
+/* @NAME: trace_wrap
+ *
+ * @DESCRIPTION: Counts a TCB3 wrap; called from the TCB3 ISR
+ *
+ * @NOTE: Count and flag change together, the level 1 gate ISR must never
+ *        see one without the other
+ *
+ */
+void trace_wrap(void) {
+
+#ifdef TRACE_CAPTURE
+    cli();
+    traceWraps++;
+    TCB3.INTFLAGS = TCB_CAPT_bm;
+    sei();
+#endif
+
+    return;
+
+}
+
+#ifdef TRACE_CAPTURE
+/* @NAME: trace_push
+ *
+ * @DESCRIPTION: Appends a record; the caller checked for room
+ *
+ */
+static void trace_push(uint8_t type, uint8_t data, uint16_t dt) {
+
+    trace_rec_t *rec = &traceRing[traceHead & (TRACE_RECORDS - 1)];
+
+    rec->type = type;
+    rec->data = data;
+    rec->dt = dt;
+
+    // publish only once the entry is complete
+    traceHead++;
+
+}
+#endif
+
+/* @NAME: trace_record
+ *
+ * @DESCRIPTION: Stamps and queues a record; use TRACE_EVENT/TRACE_SAMPLE
+ *
+ * @PARAM:
+ *          type: TRACE_* type
+ *          data: type specific byte
+ *
+ * @NOTE: A wrap still pending (flag set, counter already past 0) is
+ *        counted here so the time never runs backwards
+ *
+ */
+void trace_record(uint8_t type, uint8_t data) {
+
+#ifdef TRACE_CAPTURE
+    uint8_t sreg = SREG;
+    uint16_t cnt, wraps;
+    uint32_t now, dt;
+    uint8_t need = 1;
+
+    cli();
+    cnt = TCB3.CNT;
+    wraps = traceWraps;
+    if ((TCB3.INTFLAGS & TCB_CAPT_bm) && cnt < 0x8000) {
+        wraps++;
+    }
+    now = ((uint32_t)wraps << 16) | cnt;
+    dt = now - traceLast;
+
+    if (dt > 0xFFFF) {
+        need++;
+    }
+    if (traceLost) {
+        need++;
+    }
+
+    if ((uint8_t)(TRACE_RECORDS - (uint8_t)(traceHead - traceTail)) < need) {
+        if (traceLost < 0xFF) {
+            traceLost++;
+        }
+        SREG = sreg;
+        return;
+    }
+
+    if (traceLost) {
+        trace_push(TRACE_LOST, traceLost, 0);
+        traceLost = 0;
+    }
+    if (dt > 0xFFFF) {
+        trace_push(TRACE_GAP, 0, (dt >> 16 > 0xFFFF) ? 0xFFFF : dt >> 16);
+    }
+    trace_push(type, data, dt & 0xFFFF);
+    traceLast = now;
+
+    SREG = sreg;
+#endif
+
+    return;
+
+}
+
+/* @NAME: trace_service
+ *
+ * @DESCRIPTION: Sends every queued record as a frame via USART3; called
+ *               from the main loop
+ *
+ */
+void trace_service(void) {
+
+#ifdef TRACE_CAPTURE
+    trace_rec_t rec;
+    uint8_t frame[6];
+
+    while (traceTail != traceHead) {
+        rec = traceRing[traceTail & (TRACE_RECORDS - 1)];
+        traceTail++;
+
+        frame[0] = TRACE_SYNC;
+        frame[1] = rec.type;
+        frame[2] = rec.data;
+        frame[3] = rec.dt & 0xFF;
+        frame[4] = rec.dt >> 8;
+        frame[5] = frame[1] ^ frame[2] ^ frame[3] ^ frame[4];
+
+        for (uint8_t i = 0; i < sizeof(frame); i++) {
+            USART3_sendChar(frame[i]);
+        }
+    }
+#endif
+
+    return;
+
+}
+
+/* @NAME: trace_pending
+ *
+ * @DESCRIPTION: Returns true while records wait to be sent
+ *
+ */
+bool trace_pending(void) {
+
+#ifdef TRACE_CAPTURE
+    return traceTail != traceHead;
+#else
+    return false;
+#endif
+
+}